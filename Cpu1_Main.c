@@ -29,6 +29,16 @@
 #include "IfxScuWdt.h"
 #include "hr_and_spo2_handler.h"
 #include "sensor_timer.h"
+#include "sensor_interrupt.h"
+#include "task_loop.h"
+#include "profiler.h"
+#include "cpu_load.h"
+#include "stack_monitor.h"
+#include "shared_vitals.h"
+
+// ids of the tasks, a lower id has a higher priority
+#define TASK_READ       0       // reads the samples and calculates the values
+#define TASK_DSP        1       // calculates the values of the handed over windows, if the pipeline runs on CPU1
 
 extern IfxCpu_syncEvent g_cpuSyncEvent;
 
@@ -42,8 +52,32 @@ void handle_error(const interface_return_value_t error){
 }
 
 void handle_read(void){
+    // only post the event, reading and calculating is done by the task loop
+    post_task_event(TASK_READ);
+}
+
+void task_read(void){
     // check return value of calculation
-    handle_error(read_and_calculate_values());
+    PROFILE_BEGIN(PROFILE_READ_AND_CALCULATE);
+    interface_return_value_t error = read_and_calculate_values();
+    PROFILE_END(PROFILE_READ_AND_CALCULATE);
+    handle_error(error);
+#if HR_AND_SPO2_PIPELINE && HR_AND_SPO2_DSP_CPU == 1
+    // calculate after all reads are done
+    post_task_event(TASK_DSP);
+#endif
+}
+
+#if HR_AND_SPO2_PIPELINE && HR_AND_SPO2_DSP_CPU == 1
+void task_dsp(void){
+    // calculation errors only show up as invalid values
+    calculate_pipelined_values();
+}
+#endif
+
+void handle_data_ready(void){
+    // only queue the FIFO read, it is done by the I2C interrupts
+    request_sample_drain();
 }
 
 void handle_restart(void){
@@ -65,6 +99,17 @@ int core1_main(void)
     IfxCpu_emitEvent(&g_cpuSyncEvent);
     IfxCpu_waitEvent(&g_cpuSyncEvent, 1);
 
+    // paint the stacks to measure their peak usage
+    stack_monitor_init();
+
+    // start the performance counters of this core
+    profiler_init();
+
+#if SHARED_VITALS_STRESS_TEST
+    // publish numbered records instead of reading the sensor
+    shared_vitals_stress_writer();
+#endif
+
     // prepare oximeter 5 hardware for usage
     interface_return_value_t oximeter_error = prepare_oximeter5_hardware();
 
@@ -72,14 +117,20 @@ int core1_main(void)
     if(oximeter_error == SENSOR_ERROR)
         return -1;
 
-    // initialize read and error timers
+    // initialize the tasks, read and error timers and the data ready interrupt of the sensor
+    init_task(TASK_READ, (task_fptr_t)task_read);
+#if HR_AND_SPO2_PIPELINE && HR_AND_SPO2_DSP_CPU == 1
+    init_task(TASK_DSP, (task_fptr_t)task_dsp);
+#endif
     init_error_timer((interrupt_fptr_t)handle_restart);
     init_read_timer((interrupt_fptr_t)handle_read);
+    init_data_ready_interrupt((interrupt_fptr_t)handle_data_ready);
     // start value reading
+    start_data_ready_interrupt();
     start_read_timer();
 
-    while(1)
-    {
-    }
+    // run the tasks posted by the interrupts, the time without pending tasks is idle
+    cpu_load_init();
+    run_task_loop();
     return (1);
 }
@@ -35,9 +35,37 @@
 #include "IfxScuWdt.h"
 #include "STM_Interrupt.h"
 #include <UART.h>
+#include "hr_and_spo2_handler.h"
+#include "profiler.h"
+#include "cpu_load.h"
+#include "stack_monitor.h"
+#include "__c8x8r_driver.h"
+#include "telemetry.h"
+#include "shared_vitals.h"
 
 extern IfxCpu_syncEvent g_cpuSyncEvent;
 
+//Answers a command character received via UART
+static void handle_command(uint8 command)
+{
+    switch(command)
+    {
+#if PROFILER_ENABLED
+    case PROFILER_DUMP_COMMAND:
+        send_profile_table();
+        break;
+#endif
+    case STACK_MONITOR_DUMP_COMMAND:
+        send_stack_usage();
+        break;
+    case C8X8R_RENDER_COMMAND:
+        send_display();
+        break;
+    default:
+        break;
+    }
+}
+
 int core2_main(void)
 {
     IfxCpu_enableInterrupts();
@@ -52,15 +80,66 @@ int core2_main(void)
     IfxCpu_waitEvent(&g_cpuSyncEvent, 1);
 
 
+    //paint the stacks to measure their peak usage
+    stack_monitor_init();
+
+    //start the performance counters of this core
+    profiler_init();
+
+#if SHARED_VITALS_STRESS_TEST
+    //check the records of the writer on CPU1 instead of running the UART
+    shared_vitals_stress_reader();
+#endif
+
     //init UART to start communicating
     initUART();
 
-    //init the Timer for the regular UART communication
+    //init the queue of the UART records and the Timer which posts them
+    telemetry_init();
     initCommTimer();
 
+    //measure the load of this core, the loop is its idle loop while it has nothing to do
+    cpu_load_t load;
+    uint32 reported_windows = 0;
+    cpu_load_init();
+
     while(1)
     {
-        //watch life pass you bye.
+#if HR_AND_SPO2_PIPELINE && HR_AND_SPO2_DSP_CPU == 2
+        //calculation stage of the pipeline, errors only show up as invalid values
+        if(hr_and_spo2_pipeline_receive() != NULL_PTR){
+            cpu_load_busy();
+            calculate_pipelined_values();
+        }
+#endif
+
+        //send the records posted by the timer interrupt, as far as they fit into the transmit buffer
+        if(telemetry_pending()){
+            cpu_load_busy();
+            telemetry_drain();
+        }
+
+        //answer commands, outside of the interrupts so the transmit interrupt can empty the buffer
+        uint8 command;
+        if(uart_receiveByte(&command)){
+            cpu_load_busy();
+            handle_command(command);
+        }
+
+        //report the load of all cores and new stack warnings after every window of this core
+        cpu_load_get(IfxCpu_getCoreIndex(), &load);
+        if(load.windows != reported_windows){
+            cpu_load_busy();
+            send_cpu_load();
+            reported_windows = load.windows;
+
+            uint8 core;
+            stack_monitor_stack_t stack;
+            while(stack_monitor_take_warning(&core, &stack))
+                send_stack_warning(core, stack);
+        }
+
+        cpu_load_idle();
     }
     return (1);
 }
@@ -42,6 +42,9 @@
 #include "Ifx_Types.h"
 #include <string.h>
 #include "hr_and_spo2_handler.h"
+#include "measurement_ring.h"
+#include "memory_placement.h"
+#include "telemetry.h"
 
 /*********************************************************************************************************************/
 /*------------------------------------------------------Macros-------------------------------------------------------*/
@@ -57,16 +60,13 @@
 IfxStm_CompareConfig g_STMConf;                                 /* STM configuration structure                      */
 Ifx_TickTime g_ticksFor1s;                                   /* Variable to store the number of ticks to wait    */
 boolean timer_flag = FALSE;
-
-//Keeps track of the time since start
-uint8    seconds = 0;
-uint8    minutes = 0;
-uint8    hours = 0;
+boolean init_time_sent = FALSE;                                  /* Sensor init time is reported once              */
+boolean first_reading_sent = FALSE;                              /* Time to first reading is reported once         */
+measurement_cursor_t uart_cursor CPU2_BSS;                       /* Read position of the UART in the measurements  */
 
 /*********************************************************************************************************************/
 /*------------------------------------------------Function Prototypes------------------------------------------------*/
 /*********************************************************************************************************************/
-static void generate_timestamp(void);
 void initSTM(void);
 
 
@@ -89,24 +89,44 @@ IFX_INTERRUPT(isrSTM, 2, ISR_PRIORITY_STM);
 void isrSTM(void)
 {
 
-    uint8 spo2_value = 0;
-    sint32 heart_rate_value = 0;
+    measurement_t measurement;
+    telemetry_record_t record = {0};
 
     /* Update the compare register value that will trigger the next interrupt and toggle the LED */
     IfxStm_increaseCompare(STM, g_STMConf.comparator, g_ticksFor1s);
 
-
     /*
-     * This line checks if the values from the sensor are available and then tries to get them.
-     * If it is successfull (== SUCCESS) it generates the timestamp and sends the values via UART
+     * The interrupt only queues the records, the main loop of CPU2 formats
+     * and sends them, so a full UART buffer never stalls the interrupt
      */
 
-    interface_return_value_t oximeter_error = get_values(&spo2_value, &heart_rate_value);
+    /* Report the init time of the sensor once it is configured */
+    uint32 init_time_us = get_sensor_init_time();
+    if(!init_time_sent && init_time_us != 0){
+        record.type = TELEMETRY_INIT_TIME;
+        record.value = (sint32)init_time_us;
+        init_time_sent = telemetry_post(&record);
+    }
 
-    if(oximeter_error == SUCCESS){
-        generate_timestamp();
+    /* Report the time until the first valid values once */
+    uint32 first_reading_us = get_time_to_first_reading();
+    if(!first_reading_sent && first_reading_us != 0){
+        record.type = TELEMETRY_FIRST_READING;
+        record.value = (sint32)first_reading_us;
+        first_reading_sent = telemetry_post(&record);
+    }
 
-        send_values(heart_rate_value, spo2_value);
+    /*
+     * Every measurement published since the last interrupt is queued
+     * together with the time it was calculated
+     */
+    record.type = TELEMETRY_VALUES;
+    while(measurement_ring_read(&uart_cursor, &measurement)){
+        record.timestamp = measurement.timestamp;
+        // 0 marks a heart rate the 8 bit field cannot hold as invalid instead of truncating it
+        record.heart_rate = (measurement.heart_rate >= 0 && measurement.heart_rate <= 255) ? (uint8)measurement.heart_rate : 0;
+        record.value = measurement.spo2;
+        telemetry_post(&record);
     }
 }
 
@@ -129,34 +149,3 @@ void initCommTimer(void)
     g_ticksFor1s = IfxStm_getTicksFromMilliseconds(BSP_DEFAULT_TIMER, TIMER_INT_TIME);
     initSTM();                                      /* Configure the STM module                                     */
 }
-
-
-
-/*
- * This function generates the timestamp in this format
- * [xxh:xxm:xxs]
- * and then sends it via UART
- *
- */
-
-static void generate_timestamp(void){
-
-  //another trigger means one second has passed
-  seconds++;
-  if (seconds >= 60){
-    minutes ++;
-    seconds = seconds - 60;
-  }
-  if (minutes >= 60){
-    hours ++;
-    minutes = minutes - 60;
-  }
-
-  send_timestamp(seconds, minutes, hours);
-
-}
-
-
-
-
-
@@ -16,6 +16,11 @@
 #include "IfxCpu_Irq.h"
 #include <stdio.h>
 #include <string.h>
+#include <memory_placement.h>
+#include <profiler.h>
+#include <cpu_load.h>
+#include <stack_monitor.h>
+#include <__c8x8r_driver.h>
 
 /*************************************************************************************************************/
 /*------------------------------------------------------Macros-----------------------------------------------*/
@@ -33,17 +38,19 @@
 #define INTPRIO_ASCLIN3_ER 3                                        // Interrupt priority for UART Error
 
 #define SIZE_DEVICE_ID_STRING   23                                  // Size of string necessary for serial id
-#define SIZE_VALUES_STRING      45                                  // Size of string reserved for sending values
+#define SIZE_PROFILE_STRING     160                                 // Size of string reserved for one profiler line
+#define SIZE_LOAD_STRING        40                                  // Size of string reserved for the load of one core
 
 /*************************************************************************************************************/
 /*-------------------------------------------------Global variables------------------------------------------*/
 /*************************************************************************************************************/
-IfxAsclin_Asc asc;                                                  // Declaration of the ASC handle
-uint8 ascTxBuffer[ASC_TX_BUFFER_SIZE + sizeof(Ifx_Fifo) + 8];       // Declaration of the FIFOs parameters
-uint8 ascRxBuffer[ASC_RX_BUFFER_SIZE + sizeof(Ifx_Fifo) + 8];       // Declaration of the FIFOs parameters
+IfxAsclin_Asc asc CPU2_BSS;                                         // Declaration of the ASC handle
+uint8 ascTxBuffer[ASC_TX_BUFFER_SIZE + sizeof(Ifx_Fifo) + 8] CPU2_BSS;  // Declaration of the FIFOs parameters
+uint8 ascRxBuffer[ASC_RX_BUFFER_SIZE + sizeof(Ifx_Fifo) + 8] CPU2_BSS;  // Declaration of the FIFOs parameters
 
-static char value_string[SIZE_VALUES_STRING] = {0};                 // Buffer for values string
-static char timestamp_buf[SIZE_VALUES_STRING] = {0};                 // Buffer for values string
+static char profile_string[SIZE_PROFILE_STRING] CPU2_BSS;           // Buffer for profiler lines
+static char load_string[SIZE_LOAD_STRING] CPU2_BSS;                 // Buffer for load values
+static char display_string[C8X8R_RENDER_SIZE] CPU2_BSS;             // Buffer for the display as text
 
 /*********************************************************************************************************************/
 /*---------------------------------------------Function Implementations----------------------------------------------*/
@@ -102,6 +109,10 @@ void initUART() {
 
         IfxAsclin_Asc_initModule(&asc, &ascConfig);
 
+        /* The FIFOs are used only by CPU2 */
+        PLACEMENT_CHECK(ascTxBuffer, MEMORY_CPU2_DSPR);
+        PLACEMENT_CHECK(ascRxBuffer, MEMORY_CPU2_DSPR);
+
 }
 
 //Sends one byte via UART
@@ -115,33 +126,104 @@ void uart_sendMessage(uint8 *data, Ifx_SizeT size) {
     IfxAsclin_Asc_write(&asc, data, &size, TIME_INFINITE);
 }
 
-/*
- * This function receives two values:
- * hr (Heartrate) and SpO2 (blood oxygen saturation)
- * It converts these two values with the string.h function "snprintf" into a string and
- * then sends it via UART
- */
+//Sends a string (message) via UART if it fits into the transmit buffer, never waits
+boolean uart_trySendMessage(uint8 *data, Ifx_SizeT size) {
+    if(!IfxAsclin_Asc_canWriteCount(&asc, size, 0))
+        return FALSE;
+
+    return IfxAsclin_Asc_write(&asc, data, &size, 0);
+}
 
-void send_values(const uint8 hr, const sint32 spo2){
+//Takes one received byte without waiting, returns FALSE if nothing was received
+boolean uart_receiveByte(uint8 *byte) {
+    Ifx_SizeT count = 1;
 
-    snprintf(value_string, sizeof(value_string), "%dBPM, %d%%SpO2,\n", hr, spo2);
-    // Send converted string via UART
-    uart_sendMessage((uint8*)value_string, strlen(value_string));
+    if(IfxAsclin_Asc_getReadCount(&asc) <= 0)
+        return FALSE;
+
+    return IfxAsclin_Asc_read(&asc, byte, &count, 0);
 }
 
 /*
- * This function receives three values:
- * secs (seconds), mins (minutes) and hours (hours)
- * These values are the passed time and they get calculated in STM_Interrupt.c
- * It converts these two values with the string.h function "snprintf" into a string and
- * then sends it via UART
- *
+ * This function sends the profiler tables of all cores, one line for each
+ * probe which was called at least once. The mean values are per call.
+ * It waits for free space in the transmit buffer, so it must not be called
+ * from an interrupt with a higher priority than the transmit interrupt.
+ */
+void send_profile_table(void){
+
+    snprintf(profile_string, sizeof(profile_string), "core probe calls min max mean instructions m1 m2 m3\n");
+    uart_sendMessage((uint8*)profile_string, strlen(profile_string));
+
+    for(uint8 core = 0; core < PROFILER_CORE_COUNT; core++){
+        for(uint8 probe = 0; probe < PROFILE_PROBE_COUNT; probe++){
+            const profile_entry_t *entry = profiler_get_entry(core, (profile_probe_t)probe);
+            uint32 calls = entry->calls;
+            if(calls == 0)
+                continue;
+
+            snprintf(profile_string, sizeof(profile_string), "CPU%d %s %lu %lu %lu %lu %lu %lu %lu %lu\n",
+                     core, profiler_get_probe_name((profile_probe_t)probe), (unsigned long)calls,
+                     (unsigned long)entry->min_cycles, (unsigned long)entry->max_cycles,
+                     (unsigned long)(entry->total_cycles / calls), (unsigned long)(entry->total_instructions / calls),
+                     (unsigned long)(entry->total_m1 / calls), (unsigned long)(entry->total_m2 / calls),
+                     (unsigned long)(entry->total_m3 / calls));
+            uart_sendMessage((uint8*)profile_string, strlen(profile_string));
+        }
+    }
+}
+
+/*
+ * This function sends the load of the last window of every core, and the part
+ * of it spent in interrupts which preempted the idle loop, in one line.
+ * The values are in percent with one decimal place.
  */
-void send_timestamp (const uint8 secs, const uint8 mins, const uint8 hours){
+void send_cpu_load(void){
+    cpu_load_t load;
+
+    uart_sendMessage((uint8*)"Load", 4);
+    for(uint8 core = 0; core < CPU_LOAD_CORE_COUNT; core++){
+        cpu_load_get(core, &load);
+        snprintf(load_string, sizeof(load_string), " CPU%d %d.%d%% (irq %d.%d%%)", core,
+                 load.load_permille / 10, load.load_permille % 10, load.interrupt_permille / 10, load.interrupt_permille % 10);
+        uart_sendMessage((uint8*)load_string, strlen(load_string));
+    }
+    uart_sendMessage((uint8*)"\n", 1);
+}
 
-    snprintf(timestamp_buf, sizeof(timestamp_buf), "[%02dh:%02dm:%02ds] ", hours, mins, secs);
-    uart_sendMessage((uint8*)timestamp_buf, strlen(timestamp_buf));
+/*
+ * This function sends the peak usage and the size of the user and the
+ * interrupt stack of every core in bytes, one line per core.
+ */
+void send_stack_usage(void){
+    stack_usage_t user, interrupt;
+
+    for(uint8 core = 0; core < STACK_MONITOR_CORE_COUNT; core++){
+        stack_monitor_get_usage(core, STACK_MONITOR_USER, &user);
+        stack_monitor_get_usage(core, STACK_MONITOR_INTERRUPT, &interrupt);
+        snprintf(profile_string, sizeof(profile_string), "Stack CPU%d user %lu/%luB interrupt %lu/%luB\n", core,
+                 (unsigned long)user.peak, (unsigned long)user.size, (unsigned long)interrupt.peak, (unsigned long)interrupt.size);
+        uart_sendMessage((uint8*)profile_string, strlen(profile_string));
+    }
 }
 
+/*
+ * This function sends a warning for a stack whose peak usage crossed
+ * the warning threshold, together with its peak usage and size in bytes.
+ */
+void send_stack_warning(const uint8 core, const uint8 stack){
+    stack_usage_t usage;
 
+    stack_monitor_get_usage(core, (stack_monitor_stack_t)stack, &usage);
+    snprintf(profile_string, sizeof(profile_string), "Warning: %s stack of CPU%d used %lu/%luB\n",
+             (stack == STACK_MONITOR_USER) ? "user" : "interrupt", core, (unsigned long)usage.peak, (unsigned long)usage.size);
+    uart_sendMessage((uint8*)profile_string, strlen(profile_string));
+}
 
+/*
+ * This function sends the framebuffer of the display chain as text.
+ */
+void send_display(void){
+    c8x8r_renderChain(display_string);
+    uart_sendMessage((uint8*)display_string, strlen(display_string));
+}
@@ -44,6 +44,22 @@ void uart_blockingWrite(uint8 byte);
  */
 void uart_sendMessage(uint8 *data, Ifx_SizeT size);
 
+/***
+ * @brief: sends a char array only if it fits into the transmit buffer as a whole, without waiting
+ * @params: uint8 pointer: the char array to be transfered
+ * @params: Ifx_SizeT: the size of the char array, at most the size of the transmit buffer
+ * @return: boolean, FALSE if the buffer had no space and nothing was sent
+ */
+boolean uart_trySendMessage(uint8 *data, Ifx_SizeT size);
+
+/***
+ * @brief: a wrapper function of the IfxAsclin_Asc_read function
+ * it takes one received byte without waiting
+ * @params: uint8 pointer: the received byte
+ * @return: boolean, TRUE if a byte was received
+ */
+boolean uart_receiveByte(uint8 *byte);
+
 /***
  * @brief: a function that sends the 32 bit long serial id of the sensor
  * as a hex value via UART to the receiver
@@ -53,23 +69,45 @@ void uart_sendMessage(uint8 *data, Ifx_SizeT size);
 void send_serial_id(const uint32 serial_id);
 
 /***
- * @brief: a function that sends the two values read from the sensor
- * via UART to the receiver
- * @params: uint8, the heart rate value to be transfered
- * @params: uint8, the blood oxygen saturation value to be transfered
+ * @brief: a function that sends the calls, min/max/mean cycles, mean instructions
+ * and mean multi counter events of every probe of the profiler on every core
+ * via UART to the receiver, not from interrupts above the UART priority
+ * @params: None
+ * @return: void
+ */
+void send_profile_table(void);
+
+/***
+ * @brief: a function that sends the load of every core over the last window
+ * via UART to the receiver, not from interrupts above the UART priority
+ * @params: None
  * @return: void
  */
-void send_values(const uint8 hr, const sint32 spo2);
+void send_cpu_load(void);
 
 /***
- * @brief: a function that sends a timestamp
- * via UART to the receiver
- * @params: uint8, the amount of seconds passed to be transfered
- * @params: uint8, the amount of minutes passed to be transfered
- * @params: uint8, the amount of hours passed to be transfered
+ * @brief: a function that sends the peak usage of the user and interrupt
+ * stack of every core via UART to the receiver, not from interrupts
+ * above the UART priority
+ * @params: None
  * @return: void
  */
+void send_stack_usage(void);
 
-void send_timestamp (const uint8 secs, const uint8 mins, const uint8 hours);
+/***
+ * @brief: a function that sends a warning about the peak usage of a stack
+ * via UART to the receiver, not from interrupts above the UART priority
+ * @params: uint8, the index of the core
+ * @params: uint8, the stack, a stack_monitor_stack_t value
+ * @return: void
+ */
+void send_stack_warning(const uint8 core, const uint8 stack);
+
+/***
+ * @brief: sends the framebuffer of the display chain as text, one line per row of LEDs
+ * @params: None
+ * @return: void
+ */
+void send_display(void);
 
 #endif /* UART_H_ */
@@ -13,12 +13,14 @@
 #include <stdio.h>
 #include <string.h>
 #include "hr_and_spo2_handler.h"
+#include "measurement_ring.h"
+#include "memory_placement.h"
 /*************************************************************************************************************/
 /*-------------------------------------------------Global variables------------------------------------------*/
 /*************************************************************************************************************/
 
-IfxQspi_SpiMaster spi;
-IfxQspi_SpiMaster_Channel spiChannel;
+IfxQspi_SpiMaster spi CPU0_BSS;
+IfxQspi_SpiMaster_Channel spiChannel CPU0_BSS;
 
 
 
@@ -196,16 +198,47 @@ static uint8 ascii_matrix[][10] = {
 #define _C8X8R_DISPLAY_NORMAL_OPERATION    0x00
 #define _C8X8R_DISPLAY_TEST_MODE           0X01
 
+#define DEFAULT_INTENSITY                   _C8X8R_INTENSITY_15
+
 static uint8 _speedScroll = 3;
+// read position of the display in the measurement ring
+static measurement_cursor_t display_cursor CPU0_BSS;
+// rows last sent to each module of the chain, index 0 is digit register 1
+static uint8 framebuffer[C8X8R_CHAIN_LENGTH][IMAGE_SIZE] CPU0_BSS;
+// framebuffer matches the display, FALSE until all rows were written once
+static boolean framebuffer_valid CPU0_BSS;
+// number of commands sent to the display, no-op words included
+static uint32 spi_command_count CPU0_BSS;
+// commands of the running frame and the running single command, one word (register, data) per module, sent by the DMA
+static uint16 frame_words[(IMAGE_SIZE + 1) * C8X8R_CHAIN_LENGTH] CPU0_BSS;
+static uint16 command_words[C8X8R_CHAIN_LENGTH] CPU0_BSS;
+static uint8 frame_length CPU0_BSS;
+static uint8 frame_next CPU0_BSS;
+// rows the modules should show, sent when the running transfer is done, index 0 is digit register 1
+static uint8 target_image[C8X8R_CHAIN_LENGTH][IMAGE_SIZE] CPU0_BSS;
+static volatile boolean image_queued CPU0_BSS;
+// intensity of all modules, sent before the rows of the next frame
+static uint8 target_intensity CPU0_DATA = DEFAULT_INTENSITY;
+static boolean intensity_queued CPU0_BSS;
+// a frame transfer is running
+static volatile boolean frame_running CPU0_BSS;
+// function called when a queued image is on the display
+static c8x8r_frame_done_fptr_t frame_done_function = NULL_PTR;
 
 
 void get_globals(struct display_data *data){
 
-    sint32 bpm = 0;
-    uint8 spo2 = 90;
+    measurement_t measurement;
+    boolean received = FALSE;
 
-    interface_return_value_t oximeter_error = get_values(&spo2, &bpm);
+    // only the newest of the records since the last call is displayed
+    while(measurement_ring_read(&display_cursor, &measurement))
+        received = TRUE;
+    if(!received)
+        return;
 
+    sint32 bpm = measurement.heart_rate;
+    uint8 spo2 = measurement.spo2;
 
     // Check for input parameters
     if(bpm < 35|| bpm > 150){
@@ -247,6 +280,10 @@ void change_images(struct display_data *data,uint8 *image_big, uint8 *image_smal
 }
 
 uint32 c8x8r_getHeartFrequenz(uint8 bpm){
+    // without a pulse the period would be infinite, show a short idle beat instead
+    if(bpm == 0)
+        bpm = C8X8R_IDLE_BPM;
+
     // read the pulse (in beats per minute) sent over serial
     float pulse_BPM = bpm;
 
@@ -282,111 +319,292 @@ uint32 c8x8r_getHeartFrequenz(uint8 bpm){
 
 void c8x8r_writeCmd(uint8 command, uint8 data)
 {
-    uint8 spiTxBuffer[2] = {0};
-    spiTxBuffer[0] = command;
-    spiTxBuffer[1] = data;
-    while(IfxQspi_SpiMaster_getStatus(&spiChannel) == SpiIf_Status_busy );
-    IfxQspi_SpiMaster_exchange(&spiChannel, &spiTxBuffer, NULL_PTR, 2);
+    boolean int_enabled;
+
+    uint8 module;
+
+    // wait for the running transfer and a queued image, the commands stay in order
+    while(1)
+    {
+        int_enabled = IfxCpu_disableInterrupts();
+        if(!c8x8r_isBusy())
+            break;
+        IfxCpu_restoreInterrupts(int_enabled);
+    }
+
+    // every module of the chain gets the command, the words are read by the transfer after this function returned
+    for(module = 0; module < C8X8R_CHAIN_LENGTH; module++)
+        command_words[module] = (uint16)((command << 8) | data);
+    IfxQspi_SpiMaster_exchange(&spiChannel, command_words, NULL_PTR, C8X8R_CHAIN_LENGTH);
+    spi_command_count += C8X8R_CHAIN_LENGTH;
+    IfxCpu_restoreInterrupts(int_enabled);
 }
 
-static void _speed()
+/*
+ * Starts the next part of the running frame
+ */
+static void _sendNextBurst(void)
 {
-    switch(_speedScroll)
+#if C8X8R_CHAIN_LENGTH == 1
+    // the chip select toggles after every word, all changed rows go in one transfer
+    uint8 words = frame_length;
+#else
+    // the chip select stays active for the whole transfer, one row of all modules per transfer
+    uint8 words = C8X8R_CHAIN_LENGTH;
+#endif
+
+    IfxQspi_SpiMaster_exchange(&spiChannel, &frame_words[frame_next], NULL_PTR, words);
+    frame_next += words;
+}
+
+/*
+ * Builds the words of each row in which any module of the target image
+ * differs from the framebuffer and starts the frame. The modules whose
+ * row did not change get a no-op word. A queued intensity is sent first.
+ * Called with the interrupts disabled while no transfer is running.
+ */
+static void _startFrame(void)
+{
+    uint8 position, word, module;
+    uint8 count = 0;
+    boolean row_changed;
+
+    image_queued = FALSE;
+    if(intensity_queued)
     {
-        case 1:
-           waitTime(IfxStm_getTicksFromMilliseconds(BSP_DEFAULT_TIMER, 200));
-           break;
-        case 2:
-            waitTime(IfxStm_getTicksFromMilliseconds(BSP_DEFAULT_TIMER, 100));
-           break;
-        case 3:
-            waitTime(IfxStm_getTicksFromMilliseconds(BSP_DEFAULT_TIMER, 30));
-            break;
-        default:
-            waitTime(IfxStm_getTicksFromMilliseconds(BSP_DEFAULT_TIMER, 100));
-            break;
+        for(word = 0; word < C8X8R_CHAIN_LENGTH; word++)
+            frame_words[word] = (uint16)((_C8X8R_INTENSITY_REG << 8) | target_intensity);
+        count = C8X8R_CHAIN_LENGTH;
+        intensity_queued = FALSE;
+    }
+    for(position = 8; position > 0; position--)
+    {
+        row_changed = FALSE;
+        // the first word of a burst is shifted through to the last module of the chain
+        for(word = 0; word < C8X8R_CHAIN_LENGTH; word++)
+        {
+            module = C8X8R_CHAIN_LENGTH - 1 - word;
+            uint8 line = target_image[module][position - 1];
+            if(!framebuffer_valid || framebuffer[module][position - 1] != line)
+            {
+                frame_words[count + word] = (uint16)((position << 8) | line);
+                framebuffer[module][position - 1] = line;
+                row_changed = TRUE;
+            }
+            else
+            {
+                frame_words[count + word] = (uint16)(_C8X8R_NO_OP_REG << 8);
+            }
+        }
+        if(row_changed)
+            count += C8X8R_CHAIN_LENGTH;
+    }
+    framebuffer_valid = TRUE;
+
+    // nothing changed, no transfer needed, the image is on the display already
+    if(count == 0)
+    {
+        if(frame_done_function != NULL_PTR)
+            frame_done_function();
+        return;
     }
+
+    frame_running = TRUE;
+    frame_length = count;
+    frame_next = 0;
+    spi_command_count += count;
+    _sendNextBurst();
+}
+
+/*
+ * Marks the target image as queued and starts it if no transfer is
+ * running. Called with the interrupts disabled.
+ */
+static void _kickFrame(void)
+{
+    image_queued = TRUE;
+    if(!frame_running && IfxQspi_SpiMaster_getStatus(&spiChannel) != SpiIf_Status_busy)
+        _startFrame();
 }
 
+/*
+ * Copies images in image order into the target image, image element 0 is digit register 8
+ */
+static void _setTarget(uint8 module, uint8 *pImage)
+{
+    uint8 cnt;
 
+    for(cnt = 0; cnt < IMAGE_SIZE; cnt++)
+        target_image[module][IMAGE_SIZE - 1 - cnt] = pImage[cnt];
+}
 
-void c8x8r_displayRefresh()
+void c8x8r_queueModuleImage(uint8 module, uint8 *pImage)
 {
-   uint8 cnt;
+    boolean int_enabled;
+
+    if(module >= C8X8R_CHAIN_LENGTH)
+        return;
 
-   for( cnt = 1; cnt < 9; cnt++)
-   {
-        c8x8r_writeCmd(cnt,0x00);
-   }
+    // a newer image replaces one which is still waiting, the other modules keep theirs
+    int_enabled = IfxCpu_disableInterrupts();
+    _setTarget(module, pImage);
+    _kickFrame();
+    IfxCpu_restoreInterrupts(int_enabled);
 }
 
-void c8x8r_setSpeedScroll(uint8 speed)
+void c8x8r_queueImage(uint8 *pImage)
 {
-    _speedScroll = speed;
+    c8x8r_queueModuleImage(0, pImage);
+}
+
+void c8x8r_queueChainImage(uint8 *pImage)
+{
+    uint8 module;
+    boolean int_enabled = IfxCpu_disableInterrupts();
+
+    for(module = 0; module < C8X8R_CHAIN_LENGTH; module++)
+        _setTarget(module, &pImage[module * IMAGE_SIZE]);
+    _kickFrame();
+    IfxCpu_restoreInterrupts(int_enabled);
+}
+
+void c8x8r_queueIntensity(uint8 intensity)
+{
+    boolean int_enabled;
+
+    intensity &= _C8X8R_INTENSITY_31;
+    int_enabled = IfxCpu_disableInterrupts();
+
+    // only a change is sent, a newer intensity replaces one which is still waiting
+    if(intensity != target_intensity)
+    {
+        target_intensity = intensity;
+        intensity_queued = TRUE;
+        _kickFrame();
+    }
+    IfxCpu_restoreInterrupts(int_enabled);
 }
 
-void c8x8r_displayString(char *pArray)
+void c8x8r_setFrameDoneFunction(c8x8r_frame_done_fptr_t frame_done_function_)
 {
-    uint8 str_word[512];
-    char wrChr;
-    uint8 cnt, i;
-    uint8 global_cnt = 0;
-    uint8 charAscii;
-    uint8 position = 0;
-    uint8 col = 8;
-
-    for (i = 0; i < sizeof(pArray); i++)
+    frame_done_function = frame_done_function_;
+}
+
+void c8x8r_isrTransferDone(void)
+{
+    // the receive DMA finished, the driver is not busy anymore unless the transfer failed to finish
+    if(IfxQspi_SpiMaster_getStatus(&spiChannel) == SpiIf_Status_busy)
+        return;
+
+    if(frame_running)
     {
-        charAscii = pArray[i] - 32;
-        for( cnt = 0; cnt < 10; cnt++)
+        // the rows of a chain are sent one transfer after the other
+        if(frame_next < frame_length)
         {
-            str_word[global_cnt++] = ascii_matrix[charAscii][cnt];
+            _sendNextBurst();
+            return;
         }
+
+        frame_running = FALSE;
+        if(frame_done_function != NULL_PTR)
+            frame_done_function();
     }
 
-    while ( position < (global_cnt - 8) )
-    {
-         for( cnt = position; cnt < position + 8; cnt++)
-         {
-             wrChr = str_word[cnt];
-             c8x8r_writeCmd(col, wrChr);
-             col--;
-         }
-         col = 8;
-         position++;
-         _speed();
-     }
+    // an image queued during the transfer is sent next
+    if(image_queued)
+        _startFrame();
+}
 
+boolean c8x8r_isBusy(void)
+{
+    return image_queued || frame_running || IfxQspi_SpiMaster_getStatus(&spiChannel) == SpiIf_Status_busy;
 }
 
-void c8x8r_displayByte(char ch)
+uint32 c8x8r_getCommandCount(void)
 {
-    uint8 cnt;
-    uint8 charAscii;
-    uint8 position = 8;
-    char wrChr;
+    return spi_command_count;
+}
 
-    charAscii = ch - 32;
-    for( cnt = 2; cnt < 10; cnt++)
+void c8x8r_renderChain(char *pBuffer)
+{
+    uint8 bit, module, cnt;
+    uint32 index = 0;
+
+    // one text line per bit, the most significant bit is the top line of the display
+    for(bit = 8; bit > 0; bit--)
     {
-        wrChr = ascii_matrix[charAscii][cnt];
-        c8x8r_writeCmd(position,wrChr);
-        position--;
+        for(module = 0; module < C8X8R_CHAIN_LENGTH; module++)
+        {
+            for(cnt = 0; cnt < IMAGE_SIZE; cnt++)
+                pBuffer[index++] = (framebuffer[module][IMAGE_SIZE - 1 - cnt] & (1 << (bit - 1))) ? '#' : '.';
+        }
+        pBuffer[index++] = '\n';
     }
+    pBuffer[index] = '\0';
 }
 
-void c8x8r_displayImage(uint8 *pImage)
+uint8 c8x8r_getGlyphColumn(char ch, uint8 column)
+{
+    uint8 charAscii = (uint8)(ch - 32);
+
+    // characters without a glyph are shown as space
+    if(charAscii >= sizeof(ascii_matrix) / sizeof(ascii_matrix[0]))
+        charAscii = 0;
+    if(column >= C8X8R_GLYPH_WIDTH)
+        return 0x00;
+    return ascii_matrix[charAscii][column];
+}
+
+uint32 c8x8r_getScrollTime(void)
+{
+    switch(_speedScroll)
+    {
+        case _C8X8R_SPEED_SLOW:
+            return 200;
+        case _C8X8R_SPEED_MEDIUM:
+            return 100;
+        case _C8X8R_SPEED_FAST:
+            return 30;
+        default:
+            return 100;
+    }
+}
+
+
+
+void c8x8r_displayRefresh()
+{
+   boolean int_enabled = IfxCpu_disableInterrupts();
+
+   // all rows of all modules are sent, whatever the framebuffer holds
+   memset(target_image, 0x00, sizeof(target_image));
+   framebuffer_valid = FALSE;
+   _kickFrame();
+   IfxCpu_restoreInterrupts(int_enabled);
+}
+
+void c8x8r_setSpeedScroll(uint8 speed)
+{
+    _speedScroll = speed;
+}
+
+void c8x8r_displayByte(char ch)
 {
     uint8 cnt;
-    uint8 line;
-    uint8 position = 8;
+    uint8 image[IMAGE_SIZE];
 
-    for(cnt = 0; cnt < 8; cnt++)
+    // the first two columns of a glyph are the spacing to the previous character
+    for( cnt = 0; cnt < IMAGE_SIZE; cnt++)
     {
-        line = pImage[cnt];
-        c8x8r_writeCmd(position,line);
-        position--;
+        image[cnt] = c8x8r_getGlyphColumn(ch, cnt + C8X8R_GLYPH_WIDTH - IMAGE_SIZE);
     }
+    c8x8r_displayImage(image);
+}
+
+void c8x8r_displayImage(uint8 *pImage)
+{
+    // only the rows which differ from the framebuffer are sent, no blanking pass is needed, the DMA sends them
+    c8x8r_queueImage(pImage);
 }
 
 void initSPI(){
@@ -396,7 +614,7 @@ void initSPI(){
     // set the desired mode and maximum baudrate
     spiMasterConfig.base.mode             = SpiIf_Mode_master;
     spiMasterConfig.base.maximumBaudrate  = 100000;
-    // ISR priorities and interrupt target
+    // ISR priorities and interrupt target, with the DMA the transmit and receive priorities are the ones of the DMA channel interrupts
     spiMasterConfig.base.txPriority       = IFX_INTPRIO_QSPI0_TX;
     spiMasterConfig.base.rxPriority       = IFX_INTPRIO_QSPI0_RX;
     spiMasterConfig.base.erPriority       = IFX_INTPRIO_QSPI0_ER;
@@ -412,6 +630,11 @@ void initSPI(){
 
     spiMasterConfig.pins = &pins;
 
+    // the DMA moves the words of a frame into the QSPI, the CPU only starts the transfer
+    spiMasterConfig.dma.txDmaChannelId = C8X8R_TX_DMA_CHANNEL;
+    spiMasterConfig.dma.rxDmaChannelId = C8X8R_RX_DMA_CHANNEL;
+    spiMasterConfig.dma.useDma = 1;
+
     // initialize module
     //IfxQspi_SpiMaster spi; // defined globally
     IfxQspi_SpiMaster_initModule(&spi, &spiMasterConfig);
@@ -423,6 +646,16 @@ void initSPI(){
     spiMasterChannelConfig.base.mode.clockPolarity = 1;
     spiMasterChannelConfig.base.mode.shiftClock=0;
 
+    // one command (register, data) per word
+    spiMasterChannelConfig.base.mode.dataWidth = 16;
+#if C8X8R_CHAIN_LENGTH == 1
+    // the chip select toggles after every word so the display latches each one
+    spiMasterChannelConfig.channelBasedCs = IfxQspi_SpiMaster_ChannelBasedCs_enabled;
+#else
+    // the chip select stays active for a transfer, the chain latches the words shifted through it at the end
+    spiMasterChannelConfig.channelBasedCs = IfxQspi_SpiMaster_ChannelBasedCs_disabled;
+#endif
+
     // set the baudrate for this channel
     spiMasterChannelConfig.base.baudrate = 50000;
 
@@ -439,7 +672,7 @@ void initSPI(){
 
 void c8x8r_default_cfg () {
     c8x8r_writeCmd(_C8X8R_DECODE_MODE_REG, _C8X8R_NO_DECODE );
-    c8x8r_writeCmd(_C8X8R_INTENSITY_REG,   _C8X8R_INTENSITY_15 );
+    c8x8r_writeCmd(_C8X8R_INTENSITY_REG,   DEFAULT_INTENSITY );
     c8x8r_writeCmd(_C8X8R_SCAN_LIMIT_REG,  _C8X8R_DISPLAY_DIGIT_0_7 );
     c8x8r_writeCmd(_C8X8R_SHUTDOWN_REG,    _C8X8R_NORMAL_OPERATION );
 
@@ -448,9 +681,86 @@ void c8x8r_default_cfg () {
 }
 
 
+#if C8X8R_FRAME_VERIFY
+c8x8r_frame_verify_t c8x8r_frame_verify = {0};
+
+/*
+ * Frames of the verify sequence, each with the number of rows which differ from the frame before.
+ * The sequence starts on the blank display of c8x8r_displayRefresh.
+ */
+static const struct{
+    uint8 image[IMAGE_SIZE];
+    uint8 changed_rows;
+} verify_frames[] = {
+    {{0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, 0},     // unchanged blank frame
+    {{0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, 1},     // one changed pixel
+    {{0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, 0},     // unchanged frame
+    {{0x81, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, 1},     // second pixel in the same row
+    {{0x81, 0x18, 0x00, 0x00, 0x00, 0x00, 0x00, 0x42}, 2},     // two more rows
+    {{0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, 3},     // all lit rows cleared
+};
+
+/*
+ * Checks the commands of one step against the expected number
+ */
+static void _verifyStep(uint8 step, uint32 count_before, uint32 expected)
+{
+    // the verify runs once at init, so it waits for the frame to be sent
+    while(c8x8r_isBusy());
+
+    uint32 sent = spi_command_count - count_before;
+    c8x8r_frame_verify.steps++;
+    if(sent != expected)
+    {
+        c8x8r_frame_verify.failures++;
+        c8x8r_frame_verify.failed_step = step;
+        c8x8r_frame_verify.expected = expected;
+        c8x8r_frame_verify.sent = sent;
+    }
+}
+
+/*
+ * Sends the verify sequence and an intensity change and back, then blanks the display again
+ */
+static void _verifyFrames(void)
+{
+    uint8 step;
+    uint32 count_before;
+
+    while(c8x8r_isBusy());
+    for(step = 0; step < sizeof(verify_frames) / sizeof(verify_frames[0]); step++)
+    {
+        count_before = spi_command_count;
+        c8x8r_queueImage((uint8*)verify_frames[step].image);
+        _verifyStep(step, count_before, (uint32)verify_frames[step].changed_rows * C8X8R_CHAIN_LENGTH);
+    }
+
+    // an intensity change is one command per module, an unchanged intensity none
+    count_before = spi_command_count;
+    c8x8r_queueIntensity(_C8X8R_INTENSITY_31);
+    _verifyStep(step++, count_before, C8X8R_CHAIN_LENGTH);
+    count_before = spi_command_count;
+    c8x8r_queueIntensity(_C8X8R_INTENSITY_31);
+    _verifyStep(step++, count_before, 0);
+    count_before = spi_command_count;
+    c8x8r_queueIntensity(DEFAULT_INTENSITY);
+    _verifyStep(step++, count_before, C8X8R_CHAIN_LENGTH);
+
+    c8x8r_displayRefresh();
+}
+#endif
+
 void c8x8r_init(){
+    // the frames are built and sent by CPU0 only
+    PLACEMENT_CHECK(framebuffer, MEMORY_CPU0_DSPR);
+    PLACEMENT_CHECK(frame_words, MEMORY_CPU0_DSPR);
+
     initSPI();
     c8x8r_default_cfg();
+
+#if C8X8R_FRAME_VERIFY
+    _verifyFrames();
+#endif
 }
 
 
@@ -20,13 +20,36 @@ struct display_data{
 
 #define T_C8X8R_P    const uint8_t*
 
+typedef void (*c8x8r_frame_done_fptr_t)(void);     // function type called when a frame is on the display
+
 #define SPI_BUFFER_SIZE             3
 #define SPI_BUFFER_SIZE_CONSTANTS   30
-#define IFX_INTPRIO_QSPI0_TX        5
-#define IFX_INTPRIO_QSPI0_RX        6
+#define IFX_INTPRIO_QSPI0_TX        5               // priority of the transmit DMA channel interrupt
+#define IFX_INTPRIO_QSPI0_RX        6               // priority of the receive DMA channel interrupt
 #define IFX_INTPRIO_QSPI0_ER        8
+#define C8X8R_TX_DMA_CHANNEL        IfxDma_ChannelId_2  // channel 1 is used by the I2C of the sensor
+#define C8X8R_RX_DMA_CHANNEL        IfxDma_ChannelId_3
 
 #define IMAGE_SIZE                   8
+#define C8X8R_GLYPH_WIDTH            10             // columns of a character, the first two are the spacing
+#define C8X8R_CHAIN_LENGTH           1              // number of cascaded modules on the chip select, module 0 is next to the controller
+#define C8X8R_RENDER_SIZE            ((IMAGE_SIZE * C8X8R_CHAIN_LENGTH + 1) * 8 + 1)    // text size of c8x8r_renderChain
+#define C8X8R_RENDER_COMMAND         'd'            // Character received via UART which dumps the display as text
+#define C8X8R_IDLE_BPM               120            // beat shown without a pulse, short so new values are shown soon
+#define C8X8R_FRAME_VERIFY           0              // set to 1 to check the sent commands of a defined frame sequence at init
+
+#if C8X8R_FRAME_VERIFY
+// result of the frame sequence of c8x8r_init, read it with the debugger
+typedef struct{
+        uint32 steps;               // checked frames of the sequence
+        uint32 failures;            // frames which sent another number of commands than expected
+        uint8 failed_step;          // last failed frame
+        uint32 expected;            // commands expected for the last failed frame
+        uint32 sent;                // commands sent for the last failed frame
+} c8x8r_frame_verify_t;
+
+extern c8x8r_frame_verify_t c8x8r_frame_verify;
+#endif
 
 extern IfxQspi_SpiMaster spi;
 extern IfxQspi_SpiMaster_Channel spiChannel;
@@ -36,6 +59,7 @@ extern IfxQspi_SpiMaster_Channel spiChannel;
 #define _C8X8R_SPEED_SLOW    1
 
 // Register Address Map
+#define _C8X8R_NO_OP_REG                    0x00
 #define _C8X8R_DECODE_MODE_REG              0x09
 #define  _C8X8R_INTENSITY_REG               0x0A
 #define _C8X8R_SCAN_LIMIT_REG               0x0B
@@ -92,12 +116,20 @@ extern IfxQspi_SpiMaster_Channel spiChannel;
 
 
 
+/**
+ * @brief Function for sending one command
+ *
+ * Waits for the running transfer and a queued image, then starts the
+ * command for every module of the chain and returns. Must not be called from an interrupt above the
+ * DMA channel interrupts.
+ */
 void c8x8r_writeCmd(uint8_t command, uint8_t _data);
 
 /**
  * @brief Function for refresh display
  *
- * The function switches off all LEDs
+ * The function queues switching off all LEDs and returns immediately, all rows
+   of all modules are sent.
  */
 void c8x8r_displayRefresh();
 
@@ -107,30 +139,36 @@ void c8x8r_displayRefresh();
  * @param[in] speed        Speed that will be set
  *
  * Options:
-      Fast speed (30ms per character),
-      Medium speed (100ms per character) - default speed,
-      Slow speed ( 200ms per character),
+      Fast speed (30ms per column),
+      Medium speed (100ms per column) - default speed,
+      Slow speed ( 200ms per column),
  */
 void c8x8r_setSpeedScroll(uint8_t speed);
 
 /**
- * @brief Function for displaying one character
+ * @brief Returns the time of one scroll step
  *
- * @param[in] ch        Character to be displayed
+ * Time in ms a column is shown before the text moves on, set by c8x8r_setSpeedScroll.
+ */
+uint32 c8x8r_getScrollTime(void);
+
+/**
+ * @brief Returns one column of a character
+ *
+ * @param[in] ch           Character
+ * @param[in] column       Column of the glyph, 0 to C8X8R_GLYPH_WIDTH - 1
  *
+ * Characters without a glyph are returned as space.
  */
-void c8x8r_displayByte(char ch);
+uint8_t c8x8r_getGlyphColumn(char ch, uint8_t column);
 
 /**
- * @brief Scroll string function
+ * @brief Function for displaying one character
  *
- * @param[in] pArray       Pointer to the string to be displayed
+ * @param[in] ch        Character to be displayed
  *
- * Function that displays scrolled string with set speed.
-   If the speed is not set before calling the function,
-   default scroll speed is 100ms per character.
  */
-void c8x8r_displayString(char *pArray);
+void c8x8r_displayByte(char ch);
 
 /**
  * @brief Image display function
@@ -139,9 +177,100 @@ void c8x8r_displayString(char *pArray);
  *
  * Function for displays the image.
    The image consists of eight elements (eight columns that build the image).
+   Only the columns which changed since the last image are sent. The image is
+   queued like c8x8r_queueImage and the function returns immediately, it is on
+   the display when the frame done function is called or c8x8r_isBusy returns FALSE.
  */
 void c8x8r_displayImage(uint8_t *pArray);
 
+/**
+ * @brief Image queue function
+ *
+ * @param[in] pArray       Pointer to the image to be displayed
+ *
+ * Copies the image of module 0 and returns immediately. The changed columns
+   are sent as one DMA transfer, after the running transfer if there is one.
+   A newer image replaces one which is still waiting. Can be called from
+   interrupts.
+ */
+void c8x8r_queueImage(uint8_t *pArray);
+
+/**
+ * @brief Module image queue function
+ *
+ * @param[in] module       Module of the chain, 0 is next to the controller
+ * @param[in] pArray       Pointer to the image to be displayed
+ *
+ * Like c8x8r_queueImage for one module of the chain, the other modules keep
+   their images.
+ */
+void c8x8r_queueModuleImage(uint8_t module, uint8_t *pArray);
+
+/**
+ * @brief Chain image queue function
+ *
+ * @param[in] pArray       Pointer to C8X8R_CHAIN_LENGTH images one after the other, module 0 first
+ *
+ * Each row in which any module changed is sent as one burst over the chain,
+   the modules whose row did not change get a no-op command.
+ */
+void c8x8r_queueChainImage(uint8_t *pArray);
+
+/**
+ * @brief Intensity queue function
+ *
+ * @param[in] intensity    One of the _C8X8R_INTENSITY_* levels
+ *
+ * Queues one write of the intensity register of all modules and returns
+   immediately. It is sent before the rows of the next frame, an unchanged
+   intensity is not sent. Can be called from interrupts.
+ */
+void c8x8r_queueIntensity(uint8_t intensity);
+
+/**
+ * @brief Sets the frame done function
+ *
+ * @param[in] frame_done_function_       Function called when a queued image is on the display
+ *
+ * Called from the receive DMA interrupt at the end of a frame, or from the queue
+   function itself if no row of the image changed. NULL_PTR removes it.
+ */
+void c8x8r_setFrameDoneFunction(c8x8r_frame_done_fptr_t frame_done_function_);
+
+/**
+ * @brief Transfer done handler
+ *
+ * Called from the receive DMA interrupt after IfxQspi_SpiMaster_isrDmaReceive,
+   signals a finished frame and starts a queued image.
+ */
+void c8x8r_isrTransferDone(void);
+
+/**
+ * @brief Busy function
+ *
+ * Returns TRUE while a transfer is running or an image is queued.
+ */
+boolean c8x8r_isBusy(void);
+
+/**
+ * @brief Command count function
+ *
+ * Returns the number of commands sent to the display since startup, one per
+   module and row, no-op commands included. An unchanged frame adds 0, a frame
+   with n changed rows adds n * C8X8R_CHAIN_LENGTH.
+ */
+uint32 c8x8r_getCommandCount(void);
+
+/**
+ * @brief Renders the chain as text
+ *
+ * @param[out] pBuffer       Buffer of C8X8R_RENDER_SIZE characters
+ *
+ * Writes the framebuffer of the whole chain as eight lines of '#' (on) and
+   '.' (off), module 0 on the left. Can be called from any core.
+ */
+void c8x8r_renderChain(char *pBuffer);
+
 /**
  * @brief Init function
  *
@@ -152,7 +281,8 @@ void c8x8r_init();
 /**
  * @brief Calculates Blinking frequenz
  *
- * Calculates Blinking frequenz according to heart frequency
+ * Calculates Blinking frequenz according to heart frequency, a bpm of 0 (no pulse)
+ * beats with C8X8R_IDLE_BPM
  */
 uint32 c8x8r_getHeartFrequenz(uint8 bpm);
 
@@ -0,0 +1,150 @@
+/*
+ * cpu_load.c
+ *
+ *  Created on: 17.10.2026
+ *      Author: Andreas Reichenauer
+ */
+
+#include <IfxCpu.h>
+#include <cpu_load.h>
+#include <memory_placement.h>
+#include <seqlock.h>
+
+/*************************************************************************************************************/
+/*-------------------------------------------------Type Definitions------------------------------------------*/
+/*************************************************************************************************************/
+typedef struct
+{
+    Ifx_TickTime window_start;          // Start of the running window
+    Ifx_TickTime last_idle;             // Time of the last idle call
+    Ifx_TickTime idle_ticks;            // Idle time of the running window
+    Ifx_TickTime interrupt_ticks;       // Interrupt time of the running window
+    Ifx_TickTime window_ticks;          // Length of a window
+    Ifx_TickTime idle_gap_ticks;        // Longest idle gap
+    boolean idle;                       // Last idle call was in the running idle phase
+    uint16 max_load_permille;
+
+} cpu_load_state_t;
+
+typedef struct
+{
+    volatile uint32 sequence;           // odd while the record is written
+    volatile uint16 load_permille;
+    volatile uint16 interrupt_permille;
+    volatile uint16 max_load_permille;
+    volatile uint32 windows;
+
+} cpu_load_slot_t;
+
+/*************************************************************************************************************/
+/*-------------------------------------------------Global variables------------------------------------------*/
+/*************************************************************************************************************/
+// each core accumulates in its own DSPR and publishes the finished windows to the LMU
+static cpu_load_state_t cpu0_state CPU0_BSS;
+static cpu_load_state_t cpu1_state CPU1_BSS;
+static cpu_load_state_t cpu2_state CPU2_BSS;
+static cpu_load_state_t * const core_states[CPU_LOAD_CORE_COUNT] = {&cpu0_state, &cpu1_state, &cpu2_state};
+
+static cpu_load_slot_t load_slots[CPU_LOAD_CORE_COUNT] LMU_BSS;
+
+/*********************************************************************************************************************/
+/*---------------------------------------------Function Implementations----------------------------------------------*/
+/*********************************************************************************************************************/
+static cpu_load_slot_t *get_slot(uint8 core){
+    // all accesses go through the non-cached segment
+    return (cpu_load_slot_t*)LMU_NON_CACHED(&load_slots[core]);
+}
+
+
+static void publish_window(uint8 core, cpu_load_state_t *state, Ifx_TickTime time){
+    Ifx_TickTime window = time - state->window_start;
+    uint16 load_permille = (uint16)(((window - state->idle_ticks) * 1000) / window);
+    uint16 interrupt_permille = (uint16)((state->interrupt_ticks * 1000) / window);
+    if(load_permille > state->max_load_permille)
+        state->max_load_permille = load_permille;
+
+    // same protocol as the vitals, readers repeat a copy which overlaps the write
+    cpu_load_slot_t *slot = get_slot(core);
+    uint32 sequence = seqlock_write_begin(&slot->sequence);
+
+    slot->load_permille = load_permille;
+    slot->interrupt_permille = interrupt_permille;
+    slot->max_load_permille = state->max_load_permille;
+    slot->windows = slot->windows + 1;
+
+    seqlock_write_end(&slot->sequence, sequence);
+
+    // next window starts now
+    state->window_start = time;
+    state->idle_ticks = 0;
+    state->interrupt_ticks = 0;
+}
+
+
+void cpu_load_init(void){
+    uint8 core = IfxCpu_getCoreIndex();
+    cpu_load_state_t *state = core_states[core];
+
+    // the state is accumulated in the scratchpad of the core, the records are shared in the LMU
+    PLACEMENT_CHECK(*state, MEMORY_CPU_DSPR(core));
+    PLACEMENT_CHECK(load_slots[core], MEMORY_LMU);
+
+    state->window_ticks = IfxStm_getTicksFromMilliseconds(BSP_DEFAULT_TIMER, CPU_LOAD_WINDOW_MS);
+    state->idle_gap_ticks = IfxStm_getTicksFromMicroseconds(BSP_DEFAULT_TIMER, CPU_LOAD_IDLE_GAP_US);
+    state->window_start = now();
+    state->idle = FALSE;
+}
+
+
+void cpu_load_idle(void){
+    uint8 core = IfxCpu_getCoreIndex();
+    cpu_load_state_t *state = core_states[core];
+    Ifx_TickTime time = now();
+
+    if(state->idle){
+        // a long gap between two idle calls was an interrupt
+        Ifx_TickTime gap = time - state->last_idle;
+        if(gap <= state->idle_gap_ticks)
+            state->idle_ticks += gap;
+        else
+            state->interrupt_ticks += gap;
+    }
+    state->last_idle = time;
+    state->idle = TRUE;
+
+    if(time - state->window_start >= state->window_ticks)
+        publish_window(core, state, time);
+}
+
+
+void cpu_load_busy(void){
+    core_states[IfxCpu_getCoreIndex()]->idle = FALSE;
+}
+
+
+void cpu_load_wait(Ifx_TickTime timeout){
+    Ifx_TickTime deadline = now() + timeout;
+
+    do{
+        cpu_load_idle();
+    }while(now() < deadline);
+
+    cpu_load_busy();
+}
+
+
+void cpu_load_get(uint8 core, cpu_load_t *load){
+    if(core >= CPU_LOAD_CORE_COUNT) return;
+
+    cpu_load_slot_t *slot = get_slot(core);
+    uint32 sequence;
+
+    do{
+        sequence = seqlock_read_begin(&slot->sequence);
+
+        load->load_permille = slot->load_permille;
+        load->interrupt_permille = slot->interrupt_permille;
+        load->max_load_permille = slot->max_load_permille;
+        load->windows = slot->windows;
+    }while(seqlock_read_retry(&slot->sequence, sequence));
+}
@@ -0,0 +1,81 @@
+/*
+ * cpu_load.h
+ *
+ *  Created on: 17.10.2026
+ *      Author: Andreas Reichenauer
+ */
+
+#ifndef CPU_LOAD_H_
+#define CPU_LOAD_H_
+
+#include <Ifx_Types.h>
+#include <Bsp.h>
+
+/*********************************************************************************************************************/
+/*------------------------------------------------------Macros-------------------------------------------------------*/
+/*********************************************************************************************************************/
+#define CPU_LOAD_CORE_COUNT         3       // Number of cores with their own load
+#define CPU_LOAD_WINDOW_MS          1000    // Length of the window the load is averaged over
+#define CPU_LOAD_IDLE_GAP_US        5       // Longest time between two idle calls which is still counted as idle
+
+/*********************************************************************************************************************/
+/*---------------------------------------------Type Definitions----------------------------------------------*/
+/*********************************************************************************************************************/
+/***
+ * @brief: load of one core over the last finished window, in 0.1 % of the window. Interrupts which preempt the idle
+ * loop are counted as interrupt time, interrupts which preempt a task are counted as task time
+ */
+typedef struct
+{
+    uint16 load_permille;           // Time not spent idle, interrupt and task time
+    uint16 interrupt_permille;      // Time spent in interrupts which preempted the idle loop
+    uint16 max_load_permille;       // Highest load of all windows
+    uint32 windows;                 // Number of finished windows, 0 if there is no load yet
+
+} cpu_load_t;
+
+/*********************************************************************************************************************/
+/*---------------------------------------------Function Definitions----------------------------------------------*/
+/*********************************************************************************************************************/
+/***
+ * @brief: starts the first window of the calling core, called once by each core before its loop
+ * @params: none
+ * @returns: void
+ */
+void cpu_load_init(void);
+
+/***
+ * @brief: counts the time since the last call as idle, or as interrupt time if it took longer than
+ * CPU_LOAD_IDLE_GAP_US. Called in every iteration of the idle loop of the calling core, also closes and publishes
+ * the window. A core which does not reach its idle loop for longer than a window publishes the load over the whole
+ * time once it gets there
+ * @params: none
+ * @returns: void
+ */
+void cpu_load_idle(void);
+
+/***
+ * @brief: ends the idle time of the calling core, the time until the next idle call is counted as task time.
+ * Called before the idle loop starts work
+ * @params: none
+ * @returns: void
+ */
+void cpu_load_busy(void);
+
+/***
+ * @brief: replacement of waitTime, the wait is counted as idle time
+ * @params: Ifx_TickTime, the time to wait in STM ticks
+ * @returns: void
+ */
+void cpu_load_wait(Ifx_TickTime timeout);
+
+/***
+ * @brief: copies the load of a core from the shared stats block
+ * @params: uint8, the index of the core
+ * @params: cpu_load_t pointer, the copy of the load
+ * @returns: void
+ * @note: must not be called by an interrupt which preempts the idle loop of the core
+ */
+void cpu_load_get(uint8 core, cpu_load_t *load);
+
+#endif /* CPU_LOAD_H_ */
@@ -0,0 +1,193 @@
+/*
+ * display_animation.c
+ *
+ *  Created on: 17.10.2026
+ *      Author: Andreas Reichenauer
+ */
+
+#include <Bsp.h>
+#include <IfxCpu_Irq.h>
+#include <IfxStm.h>
+#include <display_animation.h>
+#include <__c8x8r_driver.h>
+#include <memory_placement.h>
+#include <profiler.h>
+#include <text_scroller.h>
+
+/*************************************************************************************************************/
+/*------------------------------------------------------Macros-----------------------------------------------*/
+/*************************************************************************************************************/
+#define ISR_PRIORITY_DISPLAY_FRAME  3               // Below the QSPI interrupts, which start a queued frame
+#define FRAME_STM                   (&MODULE_STM1)  // STM0 compare 0 is used by the UART timer of CPU2
+#define FRAME_COMPARATOR            IfxStm_Comparator_0
+#define MIN_FRAME_TIME_MS           1               // Shortest time a frame is shown
+#define SYSTOLE_TIME(timings)       ((timings) >> 16)
+#define DIASTOLE_TIME(timings)      ((uint16)(timings))
+
+/*************************************************************************************************************/
+/*-------------------------------------------------Type Definitions------------------------------------------*/
+/*************************************************************************************************************/
+typedef enum
+{
+    FRAME_SYSTOLE = 0,                  // big heart, start of a beat
+    FRAME_DIASTOLE                      // small heart
+
+} frame_t;
+
+/*************************************************************************************************************/
+/*-------------------------------------------------Global variables------------------------------------------*/
+/*************************************************************************************************************/
+static struct display_data vitals CPU0_BSS;                 // Values shown by the running beat
+static uint8 image_big[IMAGE_SIZE] CPU0_BSS;                // Systole image of the running beat
+static uint8 image_small[IMAGE_SIZE] CPU0_BSS;              // Diastole image of the running beat
+static uint32 beat_timings CPU0_BSS;                        // Systolic and diastolic time of the running beat in ms
+static uint32 frame_deadline CPU0_BSS;                      // STM1 time of the next frame
+static frame_t next_frame CPU0_BSS;                         // Frame shown at the deadline
+static boolean alarm_shown CPU0_BSS;                        // The alarm text of the running low SpO2 was scrolled
+#if HEART_INTENSITY_ENVELOPE
+static uint8 envelope_step CPU0_BSS;                        // Step of the phase shown at the deadline
+
+// brightness over a beat, a fast rise in the systole and a slow decay in the diastole
+static const uint8 systole_envelope[ENVELOPE_STEPS] = {
+    _C8X8R_INTENSITY_3, _C8X8R_INTENSITY_7, _C8X8R_INTENSITY_11, _C8X8R_INTENSITY_15,
+    _C8X8R_INTENSITY_19, _C8X8R_INTENSITY_23, _C8X8R_INTENSITY_27, _C8X8R_INTENSITY_31
+};
+static const uint8 diastole_envelope[ENVELOPE_STEPS] = {
+    _C8X8R_INTENSITY_29, _C8X8R_INTENSITY_23, _C8X8R_INTENSITY_17, _C8X8R_INTENSITY_13,
+    _C8X8R_INTENSITY_9, _C8X8R_INTENSITY_7, _C8X8R_INTENSITY_5, _C8X8R_INTENSITY_3
+};
+#endif
+
+/*********************************************************************************************************************/
+/*---------------------------------------------Function Implementations----------------------------------------------*/
+/*********************************************************************************************************************/
+IFX_INTERRUPT(interruptDisplayFrame, 0, ISR_PRIORITY_DISPLAY_FRAME);    // Adding the Interrupt Service Routine
+
+
+static void set_deadline(uint32 frame_time_ms){
+    if(frame_time_ms < MIN_FRAME_TIME_MS)
+        frame_time_ms = MIN_FRAME_TIME_MS;
+
+    // the deadline follows the last deadline, not the end of the SPI writes, so the beat does not drift
+    frame_deadline += (uint32)IfxStm_getTicksFromMilliseconds(FRAME_STM, frame_time_ms);
+    IfxStm_updateCompare(FRAME_STM, FRAME_COMPARATOR, frame_deadline);
+
+    // a deadline which passed while it was set would only match after the timer wrapped around
+    if((sint32)(frame_deadline - IfxStm_getLower(FRAME_STM)) <= 0){
+        frame_deadline = IfxStm_getLower(FRAME_STM) + (uint32)IfxStm_getTicksFromMilliseconds(FRAME_STM, MIN_FRAME_TIME_MS);
+        IfxStm_updateCompare(FRAME_STM, FRAME_COMPARATOR, frame_deadline);
+    }
+}
+
+
+static void start_beat(void){
+    // new values only change the animation at the start of a beat
+    get_globals(&vitals);
+    change_images(&vitals, image_big, image_small);
+    beat_timings = c8x8r_getHeartFrequenz(vitals.bpm);
+
+    // a low SpO2 scrolls the alarm once, it comes again only after the value recovered, invalid values (0) are ignored
+    if(vitals.spo2 >= SPO2_ALARM_LIMIT)
+        alarm_shown = FALSE;
+    else if(vitals.spo2 != 0 && !alarm_shown){
+        alarm_shown = TRUE;
+        text_scroller_start(SPO2_ALARM_TEXT);
+    }
+}
+
+
+#if HEART_INTENSITY_ENVELOPE
+void interruptDisplayFrame(void){
+    uint32 phase_time;
+    uint32 step_time;
+    uint8 intensity;
+
+    IfxStm_clearCompareFlag(FRAME_STM, FRAME_COMPARATOR);              // Clear the compare event
+
+    if(next_frame == FRAME_SYSTOLE){
+        if(envelope_step == 0)
+            start_beat();
+        phase_time = SYSTOLE_TIME(beat_timings);
+        intensity = systole_envelope[envelope_step];
+    }
+    else{
+        phase_time = DIASTOLE_TIME(beat_timings);
+        intensity = diastole_envelope[envelope_step];
+    }
+
+    // the last step of a phase takes the rest of its time, the steps add up to the phase
+    step_time = phase_time / ENVELOPE_STEPS;
+    if(envelope_step == ENVELOPE_STEPS - 1)
+        step_time += phase_time % ENVELOPE_STEPS;
+    set_deadline(step_time);
+
+    if(++envelope_step == ENVELOPE_STEPS){
+        envelope_step = 0;
+        next_frame = (next_frame == FRAME_SYSTOLE) ? FRAME_DIASTOLE : FRAME_SYSTOLE;
+    }
+
+    // a scrolling text is shown at full brightness, the heart comes back at the next step after it
+    if(text_scroller_is_running()){
+        c8x8r_queueIntensity(_C8X8R_INTENSITY_31);
+        return;
+    }
+
+    // the image is only sent when it changed, every other step is a single intensity write
+    PROFILE_BEGIN(PROFILE_DISPLAY_IMAGE);
+    c8x8r_queueIntensity(intensity);
+    c8x8r_queueImage(image_big);
+    PROFILE_END(PROFILE_DISPLAY_IMAGE);
+}
+
+#else
+void interruptDisplayFrame(void){
+    uint8 *image;
+
+    IfxStm_clearCompareFlag(FRAME_STM, FRAME_COMPARATOR);              // Clear the compare event
+
+    if(next_frame == FRAME_SYSTOLE){
+        start_beat();
+        set_deadline(SYSTOLE_TIME(beat_timings));
+        image = image_big;
+        next_frame = FRAME_DIASTOLE;
+    }
+    else{
+        set_deadline(DIASTOLE_TIME(beat_timings));
+        image = image_small;
+        next_frame = FRAME_SYSTOLE;
+    }
+
+    // the beat keeps its timing while a text scrolls, it is shown again at the next frame after the text
+    if(text_scroller_is_running())
+        return;
+
+    // the frame is sent by the DMA, the interrupt returns right away
+    PROFILE_BEGIN(PROFILE_DISPLAY_IMAGE);
+    c8x8r_queueImage(image);
+    PROFILE_END(PROFILE_DISPLAY_IMAGE);
+}
+#endif
+
+
+void start_display_animation(void){
+    IfxStm_CompareConfig stmConfig;
+    IfxStm_initCompareConfig(&stmConfig);
+
+    stmConfig.comparator            = FRAME_COMPARATOR;
+    stmConfig.comparatorInterrupt   = IfxStm_ComparatorInterrupt_ir0;
+    stmConfig.triggerPriority       = ISR_PRIORITY_DISPLAY_FRAME;
+    stmConfig.typeOfService         = IfxCpu_Irq_getTos(IfxCpu_getCoreIndex());
+    stmConfig.ticks                 = (uint32)IfxStm_getTicksFromMilliseconds(FRAME_STM, MIN_FRAME_TIME_MS);
+
+    // first frame is the start of a beat, the deadlines follow from there
+    next_frame = FRAME_SYSTOLE;
+    alarm_shown = FALSE;
+#if HEART_INTENSITY_ENVELOPE
+    envelope_step = 0;
+#endif
+    boolean int_enabled = IfxCpu_disableInterrupts();
+    IfxStm_initCompare(FRAME_STM, &stmConfig);
+    frame_deadline = IfxStm_getLower(FRAME_STM) + stmConfig.ticks;
+    IfxStm_updateCompare(FRAME_STM, FRAME_COMPARATOR, frame_deadline);
+    IfxCpu_restoreInterrupts(int_enabled);
+}
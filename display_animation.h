@@ -0,0 +1,42 @@
+/*
+ * display_animation.h
+ *
+ *  Created on: 17.10.2026
+ *      Author: Andreas Reichenauer
+ */
+
+#ifndef DISPLAY_ANIMATION_H_
+#define DISPLAY_ANIMATION_H_
+
+#include <Ifx_Types.h>
+
+/*********************************************************************************************************************/
+/*------------------------------------------------------Macros-------------------------------------------------------*/
+/*********************************************************************************************************************/
+#define HEART_INTENSITY_ENVELOPE    1           // 1: the big heart pulses in brightness, 0: big and small heart
+#define ENVELOPE_STEPS              8           // Intensity steps per phase (systole, diastole) of a beat
+#define SPO2_ALARM_LIMIT            90          // A SpO2 below scrolls SPO2_ALARM_TEXT once, 0 switches the alarm off
+#define SPO2_ALARM_TEXT             "SpO2 LOW"
+
+/*********************************************************************************************************************/
+/*---------------------------------------------Function Definitions----------------------------------------------*/
+/*********************************************************************************************************************/
+/***
+ * @brief: interrupt handler called at the deadline of the next frame, shows the frame and sets the following deadline
+ * @params: None
+ * @return: void
+ */
+void interruptDisplayFrame(void);
+
+/***
+ * @brief: starts the heart animation on the display, the big heart (systole) and the small heart (diastole) are
+ * shown at deadlines from c8x8r_getHeartFrequenz. With HEART_INTENSITY_ENVELOPE the big heart stays on the display
+ * and its brightness rises over the systole and falls over the diastole in ENVELOPE_STEPS steps each, which only
+ * writes the intensity register. New values are taken over at the start of each beat. The display has to be
+ * initialised with c8x8r_init first, the animation runs in the interrupts of the calling core
+ * @params: None
+ * @returns: void
+ */
+void start_display_animation(void);
+
+#endif /* DISPLAY_ANIMATION_H_ */
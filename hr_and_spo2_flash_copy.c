@@ -0,0 +1,37 @@
+/*
+ * hr_and_spo2_flash_copy.c
+ *
+ *  Created on: 17.10.2026
+ *      Author: Andreas Reichenauer
+ */
+
+/*!
+ * @file hr_and_spo2_flash_copy.c
+ * @brief This file compiles oximeter5_dsp.c a second time without the PSPR placement, so the benchmark compares the
+ * flash and the PSPR execution of the same code in one image.
+ */
+
+/*
+ * The public functions of oximeter5_dsp.c get a _flash name in this translation unit, the renames also apply to the
+ * prototypes of the included headers. A public function added to oximeter5_dsp.c without a rename here fails to
+ * link with a duplicate symbol as soon as the benchmark is enabled.
+ */
+#define oximeter5_get_oxygen_saturation     oximeter5_get_oxygen_saturation_flash
+#define oximeter5_get_heart_rate            oximeter5_get_heart_rate_flash
+#define oximeter5_find_valleys              oximeter5_find_valleys_flash
+#define oximeter5_calc_heart_rate           oximeter5_calc_heart_rate_flash
+#define oximeter5_calc_oxygen_saturation    oximeter5_calc_oxygen_saturation_flash
+#define oximeter5_select_valleys            oximeter5_select_valleys_flash
+#define oximeter5_calc_valley_ratio         oximeter5_calc_valley_ratio_flash
+#define oximeter5_calc_spo2_from_ratios     oximeter5_calc_spo2_from_ratios_flash
+#define oximeter5_analyze_window            oximeter5_analyze_window_flash
+#define oximeter5_analyze_signal            oximeter5_analyze_signal_flash
+
+// without a placement the calculation functions stay in flash
+#define HR_AND_SPO2_DSP_FLASH_COPY
+
+#include "hr_and_spo2_handler.h"
+
+#if HR_AND_SPO2_BENCHMARK && HR_AND_SPO2_DSP_IN_PSPR
+#include "oximeter5_dsp.c"
+#endif
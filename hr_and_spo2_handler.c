@@ -11,49 +11,176 @@
  */
 
 #include "hr_and_spo2_handler.h"
+#include "hr_and_spo2_stream.h"
+#include "shared_vitals.h"
+#include "measurement_ring.h"
+#include "memory_placement.h"
+#include "profiler.h"
 
-#include <Bsp.h>                      //Board support functions (for the waitTime function)
+#include <Bsp.h>                      //Board support functions (for the now function)
+#include <string.h>
 
 // oximeter 5 click context object
-static oximeter5_t oximeter5;
-// buffers for IR and red brightness values
-static uint32 ir_buffer[BUFFER_SIZE];
-static uint32 red_buffer[BUFFER_SIZE];
+static oximeter5_t oximeter5 CPU1_BSS;
+// streaming window of IR and red brightness values
+static hr_and_spo2_stream_t sample_stream CPU1_BSS;
 
-// global values for shared memory/multicore communication
-static uint8 spo2_value = 0;
-static sint32 heart_rate_value = 0;
-static IfxCpu_mutexLock resource_lock;
+// number of samples lost because the FIFO of the sensor overflowed
+static uint32 fifo_overflow_count = 0;
+// ping-pong buffers of raw FIFO bytes, word aligned for the receive DMA
+static uint32 raw_samples[2][OXIMETER5_FIFO_RAW_SIZE / sizeof(uint32)] CPU1_BSS;
+// buffer written by the running drain
+static uint8 *fill_buffer = (uint8*)raw_samples[0];
+// buffer of the last finished drain, NULL until the read takes it over
+static uint8 * volatile ready_buffer = NULL_PTR;
+static uint8 ready_count = 0;
+// outputs of the running drain
+static uint8 drain_count, drain_overflow;
+// drain is running, or failed and not reported yet
+static volatile boolean drain_busy = FALSE;
+static volatile boolean drain_failed = FALSE;
+// set if a drain was requested while it could not be started
+static volatile boolean drain_requested = FALSE;
+// number of samples appended to the window since the last calculation
+static uint16 new_sample_count = 0;
+// time from the start of the I2C initialization until the sensor is configured
+static uint32 sensor_init_time_us = 0;
+// end of the initialization and time from there until the first valid values were stored
+static Ifx_TickTime sensor_ready_time = 0;
+static uint32 first_reading_time_us = 0;
+
+#if HR_AND_SPO2_BENCHMARK
+// mask of the 31 bit CPU clock counter
+#define CLOCK_COUNTER_MASK      0x7FFFFFFF
+
+// cycle counts of the last benchmark run, read them with the debugger
+hr_and_spo2_benchmark_t hr_and_spo2_benchmark = {0};
+#endif
 
 /**
- * @brief Delay execution for 10ms function.
- * @details This function delays the execution of the program for 10ms.
+ * @brief Drain done function.
+ * @details This function is called from the I2C interrupt when the
+ * non-blocking FIFO read is finished.
  */
-static void delay_100ms ( void ){
-    waitTime(IfxStm_getTicksFromMilliseconds(BSP_DEFAULT_TIMER, 100));
+static void drain_done(oximeter5_return_value_t error_flag, void *arg){
+    if(error_flag == OXIMETER5_OK){
+        fifo_overflow_count += drain_overflow;
+
+        // hand the filled buffer to the read and fill the other one next
+        ready_count = drain_count;
+        ready_buffer = fill_buffer;
+        fill_buffer = (fill_buffer == (uint8*)raw_samples[0]) ? (uint8*)raw_samples[1] : (uint8*)raw_samples[0];
+    }
+    else{
+        drain_failed = TRUE;
+    }
+
+    drain_busy = FALSE;
 }
 
+/**
+ * @brief Start drain function.
+ * @details This function starts a non-blocking read of all pending samples
+ * from the FIFO of the Oximeter 5 into the fill buffer. If a drain is
+ * running or the other buffer is not taken over yet, the drain is started
+ * again by the next read.
+ */
+static void start_drain(void){
+    // drain state is shared between the data ready, I2C and read timer interrupts
+    boolean int_enabled = IfxCpu_disableInterrupts();
+
+    if(!drain_busy && !drain_failed && ready_buffer == NULL_PTR){
+        drain_requested = FALSE;
+        drain_busy = TRUE;
+        PROFILE_BEGIN(PROFILE_OXIMETER5_READ_FIFO);
+        oximeter5_return_value_t error_flag = oximeter5_read_fifo_raw_async(&oximeter5, fill_buffer, OXIMETER5_FIFO_DEPTH,
+                                                                            &drain_count, &drain_overflow, drain_done, NULL);
+        PROFILE_END(PROFILE_OXIMETER5_READ_FIFO);
+        if(error_flag == OXIMETER5_ERROR){
+            drain_busy = FALSE;
+            drain_failed = TRUE;
+        }
+    }
+    else{
+        drain_requested = TRUE;
+    }
+
+    IfxCpu_restoreInterrupts(int_enabled);
+}
+
+static interface_return_value_t publish_values(oximeter5_return_value_t calculation_error, oximeter5_analysis_t *analysis, boolean window_full);
+
+#if HR_AND_SPO2_BENCHMARK
+/**
+ * @brief Benchmark function.
+ * @details This function measures the CPU cycles of the two-call path,
+ * the fused analysis and the streaming evaluation on the current window,
+ * and of the flash copy of the fused analysis.
+ */
+static void run_benchmark(void){
+    uint32 *ir_window = &sample_stream.ir[sample_stream.head];
+    uint32 *red_window = &sample_stream.red[sample_stream.head];
+    uint8 spo2;
+    sint32 heart_rate;
+    oximeter5_analysis_t analysis;
+
+    uint32 start = IfxCpu_getClockCounter();
+    oximeter5_get_oxygen_saturation(ir_window, BUFFER_SIZE, red_window, &spo2);
+    oximeter5_get_heart_rate(ir_window, BUFFER_SIZE, red_window, &heart_rate);
+    hr_and_spo2_benchmark.two_call_cycles = (IfxCpu_getClockCounter() - start) & CLOCK_COUNTER_MASK;
+
+    start = IfxCpu_getClockCounter();
+    oximeter5_analyze_window(ir_window, red_window, BUFFER_SIZE, &analysis);
+    hr_and_spo2_benchmark.fused_cycles = (IfxCpu_getClockCounter() - start) & CLOCK_COUNTER_MASK;
+
+    start = IfxCpu_getClockCounter();
+    hr_and_spo2_stream_evaluate(&sample_stream, &analysis);
+    hr_and_spo2_benchmark.stream_cycles = (IfxCpu_getClockCounter() - start) & CLOCK_COUNTER_MASK;
+
+#if HR_AND_SPO2_DSP_IN_PSPR
+    start = IfxCpu_getClockCounter();
+    oximeter5_analyze_window_flash(ir_window, red_window, BUFFER_SIZE, &analysis);
+    hr_and_spo2_benchmark.fused_flash_cycles = (IfxCpu_getClockCounter() - start) & CLOCK_COUNTER_MASK;
+#endif
+
+    hr_and_spo2_benchmark.runs++;
+    hr_and_spo2_benchmark.dsp_in_pspr = HR_AND_SPO2_DSP_IN_PSPR;
+}
+#endif
+
 interface_return_value_t prepare_oximeter5_hardware(void){
-    // initialize I2C and Oximeter 5 and wait 100ms after
+    Ifx_TickTime init_start = now();
+
+    // the samples are used by CPU1 and its DMA only
+    PLACEMENT_CHECK(sample_stream, MEMORY_CPU1_DSPR);
+    PLACEMENT_CHECK(raw_samples, MEMORY_CPU1_DSPR);
+
+    // initialize I2C and Oximeter 5
     oximeter5_init(&oximeter5);
-    delay_100ms();
 
-    // set default configuration to Oximeter 5 and wait 100ms after
+    // set default configuration to Oximeter 5, it waits for the end of the reset itself
     if(oximeter5_default_cfg(&oximeter5) == OXIMETER5_ERROR)
         return SENSOR_ERROR;
-    delay_100ms();
 
-    // read values if hardware interrupt occurs and fill up buffers
-    for(uint8 n_cnt = 0; n_cnt < BUFFER_SIZE; n_cnt++){
-        while(oximeter5_check_interrupt(&oximeter5) == OXIMETER5_INTERRUPT_ACTIVE);
-        if(oximeter5_read_sensor_data(&oximeter5, &red_buffer[n_cnt], &ir_buffer[n_cnt]) == OXIMETER5_ERROR)
-            return SENSOR_ERROR;
-    }
+    sensor_ready_time = now();
+    sensor_init_time_us = (uint32)((sensor_ready_time - init_start) / IfxStm_getTicksFromMicroseconds(BSP_DEFAULT_TIMER, 1));
 
-    // spo2 test calculation with read values
-    uint8 spo2_test = 255;
-    if(oximeter5_get_oxygen_saturation(&ir_buffer[0], BUFFER_SIZE, &red_buffer[0], &spo2_test) == OXIMETER5_ERROR)
-        return CALCULATION_ERROR;
+    // from now on the sensor is only accessed by non-blocking transfers
+    init_i2c_job_queue(&oximeter5.i2c);
+
+    // start with an empty window, it is filled by the reads after each data ready interrupt
+    hr_and_spo2_stream_init(&sample_stream);
+    new_sample_count = 0;
+    // the INT pin may already be active, so drain once without an edge
+    ready_buffer = NULL_PTR;
+    drain_busy = FALSE;
+    drain_failed = FALSE;
+    drain_requested = TRUE;
+
+#if HR_AND_SPO2_BENCHMARK
+    // start the cycle counter used by the benchmark
+    IfxCpu_resetAndStartCounters(IfxCpu_CounterMode_normal);
+#endif
 
     // no errors occurred
     return SUCCESS;
@@ -61,65 +188,184 @@ interface_return_value_t prepare_oximeter5_hardware(void){
 
 
 interface_return_value_t read_and_calculate_values(void){
-    // shift values in buffers forwards by one sampling interval so end can be filled with next measurement
-    for(uint8 n_cnt = SAMPLING_FREQUENCY; n_cnt < BUFFER_SIZE; n_cnt++){
-        red_buffer[n_cnt - SAMPLING_FREQUENCY] = red_buffer[n_cnt];
-        ir_buffer[n_cnt - SAMPLING_FREQUENCY] = ir_buffer[n_cnt];
+    if(drain_failed){
+        drain_failed = FALSE;
+        return SENSOR_ERROR;
+    }
+
+    // take over the buffer of a finished drain, the next drain fills the other one
+    boolean int_enabled = IfxCpu_disableInterrupts();
+    uint8 *samples = ready_buffer;
+    uint8 sample_count = ready_count;
+    ready_buffer = NULL_PTR;
+    IfxCpu_restoreInterrupts(int_enabled);
+
+    // INT is low active, a sample arriving during the drain keeps it low without a new edge
+    if(samples != NULL_PTR && sample_count < OXIMETER5_FIFO_DEPTH){
+        PROFILE_BEGIN(PROFILE_OXIMETER5_CHECK_INTERRUPT);
+        uint8 interrupt_state = oximeter5_check_interrupt(&oximeter5);
+        PROFILE_END(PROFILE_OXIMETER5_CHECK_INTERRUPT);
+        if(interrupt_state == OXIMETER5_INTERRUPT_INACTIVE)
+            drain_requested = TRUE;
     }
+    else if(samples != NULL_PTR)
+        drain_requested = TRUE;
+
+    // the next drain runs on the bus while these samples are processed
+    if(drain_requested)
+        start_drain();
 
-    // fill up end of buffers with next measurements when hardware interrupt occurs
-    for(uint8 n_cnt = (BUFFER_SIZE - SAMPLING_FREQUENCY); n_cnt < BUFFER_SIZE; n_cnt++){
-        while(oximeter5_check_interrupt(&oximeter5) == OXIMETER5_INTERRUPT_ACTIVE);
-        if(oximeter5_read_sensor_data(&oximeter5, &red_buffer[n_cnt], &ir_buffer[n_cnt]) == OXIMETER5_ERROR)
-            return SENSOR_ERROR;
+    // unpack the samples directly into the window, oldest ones are dropped
+    for(uint8 n_cnt = 0; samples != NULL_PTR && n_cnt < sample_count; n_cnt++){
+        uint32 ir_sample, red_sample;
+        PROFILE_BEGIN(PROFILE_OXIMETER5_UNPACK_SAMPLE);
+        oximeter5_unpack_sample(&samples[n_cnt * OXIMETER5_FIFO_SAMPLE_SIZE], &red_sample, &ir_sample);
+        PROFILE_END(PROFILE_OXIMETER5_UNPACK_SAMPLE);
+        hr_and_spo2_stream_push(&sample_stream, ir_sample, red_sample);
     }
+    if(samples != NULL_PTR)
+        new_sample_count += sample_count;
 
-    uint8 spo2_temp = INVALID_SPO2;
-    sint32 hr_temp = INVALID_HR;
+    // calculate once per second of new samples, while the window fills up after every read to get a first reading early
+    boolean window_full = (sample_stream.count == BUFFER_SIZE);
+    if(window_full ? new_sample_count < SAMPLING_FREQUENCY : (samples == NULL_PTR || sample_stream.count < HR_AND_SPO2_STREAM_MIN_SAMPLES))
+        return SUCCESS;
+    new_sample_count = 0;
 
-    // calculate heart rate and spo2 values from buffers
-    oximeter5_return_value_t calculation_error = oximeter5_get_oxygen_saturation(&ir_buffer[0], BUFFER_SIZE, &red_buffer[0], &spo2_temp);
-    calculation_error |= oximeter5_get_heart_rate(&ir_buffer[0], BUFFER_SIZE, &red_buffer[0], &hr_temp);
+#if HR_AND_SPO2_PIPELINE
+    // hand a copy of the window to the calculation stage, the next reads continue on the stream meanwhile
+    hr_and_spo2_window_t *window = hr_and_spo2_pipeline_acquire();
+    if(window == NULL_PTR)
+        return SUCCESS;
 
-    // check if mutex locked
-    boolean mutex_flag = IfxCpu_acquireMutex(&resource_lock);
+    /*
+     * This copy is an intentional cost. Consecutive windows overlap in all but the last second of samples, and the
+     * stream overwrites its oldest samples while the calculation still reads the window. Handing over the stream
+     * itself would need a lock or a stream per pool window. The samples are stored once in the stream and copied
+     * once per calculation, about 2 * BUFFER_SIZE words into the non-cached LMU, the probe measures it.
+     */
+    PROFILE_BEGIN(PROFILE_PIPELINE_COPY);
+    memcpy(window->ir, &sample_stream.ir[sample_stream.head], sample_stream.count * sizeof(uint32));
+    memcpy(window->red, &sample_stream.red[sample_stream.head], sample_stream.count * sizeof(uint32));
+    PROFILE_END(PROFILE_PIPELINE_COPY);
+    window->count = sample_stream.count;
+    window->window_full = window_full;
+    hr_and_spo2_pipeline_submit();
 
-    // if locked return with save error
-    if (!mutex_flag){
-        return SAVE_ERROR;
-    }
+    // no errors occurred
+    return SUCCESS;
+#else
+    oximeter5_analysis_t analysis;
+
+    // calculate heart rate and spo2 values from window
+    oximeter5_return_value_t calculation_error = hr_and_spo2_stream_evaluate(&sample_stream, &analysis);
+
+#if HR_AND_SPO2_BENCHMARK
+    if(window_full)
+        run_benchmark();
+#endif
+
+    return publish_values(calculation_error, &analysis, window_full);
+#endif
+}
 
-    // if not locked save calculated values into global variables, if there was a calculation error use invalid values
-    spo2_value = (calculation_error == OXIMETER5_ERROR) ? INVALID_SPO2 : spo2_temp;
-    heart_rate_value = (calculation_error == OXIMETER5_ERROR) ? INVALID_HR : hr_temp;
+#if HR_AND_SPO2_PIPELINE
+interface_return_value_t calculate_pipelined_values(void){
+    // oldest window handed over by the acquisition stage
+    hr_and_spo2_window_t *window = hr_and_spo2_pipeline_receive();
+    if(window == NULL_PTR)
+        return SUCCESS;
 
-    // don't forget to release mutex after access
-    IfxCpu_releaseMutex(&resource_lock);
+    oximeter5_analysis_t analysis;
+
+    // calculate heart rate and spo2 values from the window in place
+    PROFILE_BEGIN(PROFILE_OXIMETER5_ANALYZE_WINDOW);
+    oximeter5_return_value_t calculation_error = oximeter5_analyze_window(window->ir, window->red, window->count, &analysis);
+    PROFILE_END(PROFILE_OXIMETER5_ANALYZE_WINDOW);
+    boolean window_full = window->window_full;
+
+    // the window can be filled again
+    hr_and_spo2_pipeline_release();
+
+    return publish_values(calculation_error, &analysis, window_full);
+}
+#endif
+
+/**
+ * @brief Publish values function.
+ * @details This function publishes the result of one calculation to the
+ * other cores.
+ */
+static interface_return_value_t publish_values(oximeter5_return_value_t calculation_error, oximeter5_analysis_t *analysis, boolean window_full){
+    // a partial window without two valleys yet keeps the last provisional values
+    if(!window_full && calculation_error == OXIMETER5_ERROR)
+        return CALCULATION_ERROR;
+
+    // publish calculated values to the other cores, if there was a calculation error use invalid values
+    shared_vitals_t vitals;
+    vitals.spo2 = (calculation_error == OXIMETER5_ERROR) ? INVALID_SPO2 : analysis->spo2;
+    vitals.heart_rate = (calculation_error == OXIMETER5_ERROR) ? INVALID_HR : analysis->heart_rate;
+    if(calculation_error == OXIMETER5_ERROR)
+        vitals.confidence = CONFIDENCE_NONE;
+    else
+        vitals.confidence = window_full ? CONFIDENCE_FULL : CONFIDENCE_PROVISIONAL;
+
+    // broadcast every result with its time to the consumer cores
+    measurement_t measurement;
+    measurement.timestamp = (uint64)now();
+    measurement.heart_rate = vitals.heart_rate;
+    measurement.spo2 = vitals.spo2;
+    measurement.quality = vitals.confidence;
+
+    // readers on the same core, like the UART interrupt next to the pipeline stage on CPU2, must not preempt the writes
+    boolean int_enabled = IfxCpu_disableInterrupts();
+    shared_vitals_publish(&vitals);
+    measurement_ring_publish(&measurement);
+    IfxCpu_restoreInterrupts(int_enabled);
 
     // calculation error occurred
     if(calculation_error == OXIMETER5_ERROR)
         return CALCULATION_ERROR;
 
+    if(first_reading_time_us == 0)
+        first_reading_time_us = (uint32)((now() - sensor_ready_time) / IfxStm_getTicksFromMicroseconds(BSP_DEFAULT_TIMER, 1));
+
     // no errors occurred
     return SUCCESS;
 }
 
 interface_return_value_t get_values(uint8 *spo2, sint32 *heart_rate){
-    // check if mutex locked
-    boolean mutex_flag = IfxCpu_acquireMutex(&resource_lock);
+    hr_and_spo2_confidence_t confidence;
 
-    // if locked return with load error
-    if (!mutex_flag){
-        return LOAD_ERROR;
-    }
+    return get_values_with_confidence(spo2, heart_rate, &confidence);
+}
+
+interface_return_value_t get_values_with_confidence(uint8 *spo2, sint32 *heart_rate, hr_and_spo2_confidence_t *confidence){
+    shared_vitals_t vitals;
 
-    // if not locked write last values to output parameters
-    *spo2 = spo2_value;
-    *heart_rate = heart_rate_value;
+    // consistent copy of the last published values, the read never fails
+    shared_vitals_read(&vitals);
 
-    // don't forget to release mutex after access
-    IfxCpu_releaseMutex(&resource_lock);
+    *spo2 = vitals.spo2;
+    *heart_rate = vitals.heart_rate;
+    *confidence = (hr_and_spo2_confidence_t)vitals.confidence;
 
     // no errors occurred
     return SUCCESS;
 }
+
+void request_sample_drain(void){
+    start_drain();
+}
+
+uint32 get_sensor_init_time(void){
+    return sensor_init_time_us;
+}
+
+uint32 get_time_to_first_reading(void){
+    return first_reading_time_us;
+}
+
+uint32 get_fifo_overflow_count(void){
+    return fifo_overflow_count;
+}
@@ -14,11 +14,16 @@
 #define HR_AND_SPO2_HANDLER_H_
 
 #include "oximeter5_click.h"
+#include "hr_and_spo2_pipeline.h"
 
 // value which is treated as invalid result
 #define INVALID_SPO2    0
 #define INVALID_HR      0
 
+// set to 1 to compare the cycles of the fused analysis with the two-call path after every calculation, and the
+// PSPR with the flash execution of the fused analysis (hr_and_spo2_flash_copy.c compiles the flash copy)
+#define HR_AND_SPO2_BENCHMARK   0
+
 /**
  * @brief Hardware Interface return value data.
  * @details Predefined enum values for hardware interface return values.
@@ -33,11 +38,50 @@ typedef enum
 
 } interface_return_value_t;
 
+/**
+ * @brief Value confidence data.
+ * @details Predefined enum values for the confidence of the stored values.
+ */
+typedef enum
+{
+    CONFIDENCE_NONE = 0,            /**< No valid values calculated yet. */
+    CONFIDENCE_PROVISIONAL = 1,     /**< Values of a window which is not full yet. */
+    CONFIDENCE_FULL = 2             /**< Values of a full window. */
+
+} hr_and_spo2_confidence_t;
+
+#if HR_AND_SPO2_BENCHMARK
+/**
+ * @brief Benchmark result data.
+ * @details CPU cycles of the last calculation, measured with the CPU clock counter.
+ */
+typedef struct
+{
+    uint32 two_call_cycles;     /**< oximeter5_get_oxygen_saturation + oximeter5_get_heart_rate. */
+    uint32 fused_cycles;        /**< oximeter5_analyze_window. */
+    uint32 stream_cycles;       /**< hr_and_spo2_stream_evaluate. */
+    uint32 fused_flash_cycles;  /**< oximeter5_analyze_window executed from flash, 0 if it is executed from flash anyway. */
+    uint32 runs;                /**< Number of benchmark runs. */
+    uint32 dsp_in_pspr;         /**< Calculation functions executed from PSPR (#HR_AND_SPO2_DSP_IN_PSPR). */
+
+} hr_and_spo2_benchmark_t;
+
+extern hr_and_spo2_benchmark_t hr_and_spo2_benchmark;
+#endif
+
+#if HR_AND_SPO2_BENCHMARK && HR_AND_SPO2_DSP_IN_PSPR
+/**
+ * @brief Flash copy of #oximeter5_analyze_window.
+ * @details Same code without the PSPR placement, for the benchmark only.
+ */
+oximeter5_return_value_t oximeter5_analyze_window_flash ( uint32 *pun_ir_buffer, uint32 *pun_red_buffer, sint32 n_buffer_length, oximeter5_analysis_t *p_result );
+#endif
+
 /**
  * @brief Oximeter 5 hardware startup function.
  * @details This function initializes all necessary pins and peripherals used
- * for this click board, resets the sensor, sets all operation modes and does
- * an initial reading.
+ * for this click board, resets the sensor, sets all operation modes and
+ * empties the sample window.
  * @params: None.
  * @return @li @c  0 - Success,
  *         @li @c -1 - Error Oximeter 5,
@@ -51,20 +95,41 @@ interface_return_value_t prepare_oximeter5_hardware(void);
 
 /**
  * @brief Oximeter 5 reading and saving function.
- * @details This function reads the brightness values from the Oximeter 5 and
- * calculates spo2 and heart rate values based on read samples. The calculated
- * values are stored to the shared memory.
+ * @details This function appends the brightness values of the last finished
+ * FIFO read to the window and starts the next read if needed. Once a second
+ * of new samples is collected spo2 and heart rate values are calculated from
+ * the window and stored to the shared memory. While the window fills up after
+ * startup the values are calculated after every read and stored as
+ * provisional values as soon as two valleys are found. With
+ * #HR_AND_SPO2_PIPELINE the window is only handed over to
+ * #calculate_pipelined_values instead.
  * @params: None.
  * @return @li @c  0 - Success,
  *         @li @c -1 - Error Oximeter 5,
  *         @li @c -2 - Error calculating values,
- *         @li @c -3 - Error saving values,
  *
  * See #interface_return_value_t definition for detailed explanation.
  * @note None.
  */
 interface_return_value_t read_and_calculate_values(void);
 
+#if HR_AND_SPO2_PIPELINE
+/**
+ * @brief Oximeter 5 pipelined calculation function.
+ * @details This function is the calculation stage of the pipeline. It
+ * calculates spo2 and heart rate values of the oldest window handed over by
+ * #read_and_calculate_values and stores them to the shared memory. It is
+ * called by the loop of #HR_AND_SPO2_DSP_CPU.
+ * @params: None.
+ * @return @li @c  0 - Success or no window waiting,
+ *         @li @c -2 - Error calculating values,
+ *
+ * See #interface_return_value_t definition for detailed explanation.
+ * @note None.
+ */
+interface_return_value_t calculate_pipelined_values(void);
+#endif
+
 /**
  * @brief Oximeter 5 get values function.
  * @details This function retrieves the calculated spo2 and heart rate values
@@ -72,13 +137,67 @@ interface_return_value_t read_and_calculate_values(void);
  * @param[out] spo2 : SPO2 value stored in shared memory.
  * @param[out] heart_rate : heart rate value stored in shared memory.
  * @return @li @c  0 - Success,
- *         @li @c -1 - Error Oximeter 5,
- *         @li @c -2 - Error calculating values,
- *         @li @c -3 - Error saving values,
  *
  * See #interface_return_value_t definition for detailed explanation.
- * @note None.
+ * @note The values are read without a lock, so the call never fails.
  */
 interface_return_value_t get_values(uint8 *spo2, sint32 *heart_rate);
 
+/**
+ * @brief Oximeter 5 get values with confidence function.
+ * @details This function retrieves the calculated spo2 and heart rate values
+ * together with their confidence from the shared memory.
+ * @param[out] spo2 : SPO2 value stored in shared memory.
+ * @param[out] heart_rate : heart rate value stored in shared memory.
+ * @param[out] confidence : confidence of the stored values.
+ * See #hr_and_spo2_confidence_t definition for detailed explanation.
+ * @return @li @c  0 - Success,
+ *
+ * See #interface_return_value_t definition for detailed explanation.
+ * @note None.
+ */
+interface_return_value_t get_values_with_confidence(uint8 *spo2, sint32 *heart_rate, hr_and_spo2_confidence_t *confidence);
+
+/**
+ * @brief Oximeter 5 request sample drain function.
+ * @details This function starts a non-blocking read of the FIFO of the
+ * sensor, the samples are taken over by the next call of
+ * #read_and_calculate_values. It is short enough to be called from the
+ * data ready interrupt.
+ * @params: None.
+ * @return Nothing.
+ * @note None.
+ */
+void request_sample_drain(void);
+
+/**
+ * @brief Oximeter 5 get sensor init time function.
+ * @details This function returns the time #prepare_oximeter5_hardware needed
+ * from the start of the I2C initialization until the sensor was configured.
+ * @params: None.
+ * @return Init time in microseconds.
+ * @note None.
+ */
+uint32 get_sensor_init_time(void);
+
+/**
+ * @brief Oximeter 5 get time to first reading function.
+ * @details This function returns the time from the end of
+ * #prepare_oximeter5_hardware until the first valid values were stored.
+ * @params: None.
+ * @return Time to first reading in microseconds, 0 if there is none yet.
+ * @note None.
+ */
+uint32 get_time_to_first_reading(void);
+
+/**
+ * @brief Oximeter 5 get FIFO overflow count function.
+ * @details This function returns the number of samples which were lost
+ * because the FIFO of the sensor was full before it was read.
+ * @params: None.
+ * @return Number of lost samples since startup.
+ * @note The sensor counts at most 31 lost samples between two reads.
+ */
+uint32 get_fifo_overflow_count(void);
+
 #endif /* HR_AND_SPO2_HANDLER_H_ */
@@ -0,0 +1,82 @@
+/*
+ * hr_and_spo2_pipeline.c
+ *
+ *  Created on: 17.10.2026
+ *      Author: Andreas Reichenauer
+ */
+
+/*!
+ * @file hr_and_spo2_pipeline.c
+ * @brief This file implements the window pool which hands sample windows from the acquisition to the calculation core.
+ */
+
+#include <IfxCpu.h>
+#include "hr_and_spo2_pipeline.h"
+#include "memory_placement.h"
+
+/**
+ * @brief Window pool object.
+ * @details Single producer single consumer ring of windows. The acquisition
+ * stage only writes @c submitted, the calculation stage only writes
+ * @c released, so no lock is needed.
+ */
+typedef struct
+{
+    hr_and_spo2_window_t windows[ HR_AND_SPO2_PIPELINE_DEPTH ];
+    volatile uint32 submitted;      /**< Number of windows handed to the calculation stage. */
+    volatile uint32 released;       /**< Number of windows returned to the pool. */
+
+} hr_and_spo2_pool_t;
+
+// pool in the LMU, written by one core and read by another
+static hr_and_spo2_pool_t window_pool LMU_BSS;
+// windows the acquisition stage could not hand over
+static uint32 dropped_windows = 0;
+
+static hr_and_spo2_pool_t *get_pool(void){
+    // all accesses go through the non-cached segment
+    return (hr_and_spo2_pool_t*)LMU_NON_CACHED(&window_pool);
+}
+
+hr_and_spo2_window_t *hr_and_spo2_pipeline_acquire(void){
+    hr_and_spo2_pool_t *pool = get_pool();
+
+    // all windows are waiting for the calculation
+    if(pool->submitted - pool->released >= HR_AND_SPO2_PIPELINE_DEPTH){
+        dropped_windows++;
+        return NULL_PTR;
+    }
+
+    return &pool->windows[pool->submitted % HR_AND_SPO2_PIPELINE_DEPTH];
+}
+
+void hr_and_spo2_pipeline_submit(void){
+    hr_and_spo2_pool_t *pool = get_pool();
+
+    // the samples are written before the window is handed over
+    __dsync();
+    pool->submitted = pool->submitted + 1;
+}
+
+hr_and_spo2_window_t *hr_and_spo2_pipeline_receive(void){
+    hr_and_spo2_pool_t *pool = get_pool();
+
+    if(pool->submitted == pool->released)
+        return NULL_PTR;
+
+    // the window is read after it was handed over
+    __dsync();
+    return &pool->windows[pool->released % HR_AND_SPO2_PIPELINE_DEPTH];
+}
+
+void hr_and_spo2_pipeline_release(void){
+    hr_and_spo2_pool_t *pool = get_pool();
+
+    // the samples are read before the window can be filled again
+    __dsync();
+    pool->released = pool->released + 1;
+}
+
+uint32 hr_and_spo2_pipeline_get_dropped(void){
+    return dropped_windows;
+}
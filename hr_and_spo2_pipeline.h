@@ -0,0 +1,94 @@
+/*
+ * hr_and_spo2_pipeline.h
+ *
+ *  Created on: 17.10.2026
+ *      Author: Andreas Reichenauer
+ */
+
+/*!
+ * @file hr_and_spo2_pipeline.h
+ * @brief This file contains the window pool which hands sample windows from the acquisition to the calculation core.
+ */
+
+#ifndef HR_AND_SPO2_PIPELINE_H_
+#define HR_AND_SPO2_PIPELINE_H_
+
+#include "oximeter5_click.h"
+#include "memory_placement.h"
+
+// set to 1 to calculate the values on another stage than the acquisition, HR_AND_SPO2_DSP_CPU of memory_placement.h
+// selects the core of the calculation stage, 1 runs it as a low priority task next to the acquisition
+#define HR_AND_SPO2_PIPELINE        0
+// number of windows which can wait for the calculation
+#define HR_AND_SPO2_PIPELINE_DEPTH  2
+
+#if !HR_AND_SPO2_PIPELINE && HR_AND_SPO2_DSP_CPU != 1
+#error "Without HR_AND_SPO2_PIPELINE the calculation runs on CPU1, set HR_AND_SPO2_DSP_CPU to 1"
+#endif
+
+/**
+ * @brief Pipeline window object.
+ * @details Samples of one window in time order, copied from the streaming
+ * window by the acquisition stage and read in place by the calculation stage.
+ */
+typedef struct
+{
+    uint32 ir[ BUFFER_SIZE ];       /**< IR samples, oldest first. */
+    uint32 red[ BUFFER_SIZE ];      /**< Red samples, oldest first. */
+    uint16 count;                   /**< Number of samples in the window. */
+    boolean window_full;            /**< Window holds #BUFFER_SIZE samples, otherwise the result is provisional. */
+
+} hr_and_spo2_window_t;
+
+/**
+ * @brief Pipeline acquire function.
+ * @details This function returns the next free window of the pool for the
+ * acquisition stage.
+ * @params: None.
+ * @return Free window, NULL if all windows wait for the calculation.
+ * @note A window which can not be handed over is counted as dropped.
+ */
+hr_and_spo2_window_t *hr_and_spo2_pipeline_acquire(void);
+
+/**
+ * @brief Pipeline submit function.
+ * @details This function hands the window returned by the last
+ * #hr_and_spo2_pipeline_acquire call to the calculation stage. Only the
+ * position in the pool is passed, the samples are not copied.
+ * @params: None.
+ * @return Nothing.
+ * @note None.
+ */
+void hr_and_spo2_pipeline_submit(void);
+
+/**
+ * @brief Pipeline receive function.
+ * @details This function returns the oldest window submitted to the
+ * calculation stage.
+ * @params: None.
+ * @return Submitted window, NULL if there is none.
+ * @note The window stays valid until #hr_and_spo2_pipeline_release.
+ */
+hr_and_spo2_window_t *hr_and_spo2_pipeline_receive(void);
+
+/**
+ * @brief Pipeline release function.
+ * @details This function returns the window of the last
+ * #hr_and_spo2_pipeline_receive call to the pool.
+ * @params: None.
+ * @return Nothing.
+ * @note None.
+ */
+void hr_and_spo2_pipeline_release(void);
+
+/**
+ * @brief Pipeline get dropped count function.
+ * @details This function returns the number of windows which were not
+ * handed over because the calculation stage was behind.
+ * @params: None.
+ * @return Number of dropped windows since startup.
+ * @note None.
+ */
+uint32 hr_and_spo2_pipeline_get_dropped(void);
+
+#endif /* HR_AND_SPO2_PIPELINE_H_ */
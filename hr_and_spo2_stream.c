@@ -0,0 +1,305 @@
+/*
+ * hr_and_spo2_stream.c
+ *
+ *  Created on: 17.10.2026
+ *      Author: Andreas Reichenauer
+ */
+
+/*!
+ * @file hr_and_spo2_stream.c
+ * @brief This file implements the streaming sample window used for the heart rate and SpO2 calculation.
+ */
+
+#include "hr_and_spo2_stream.h"
+#include "memory_placement.h"
+#include "profiler.h"
+
+#if HR_AND_SPO2_STREAM_VERIFY
+// result of the comparison with the two-call path, read it with the debugger
+hr_and_spo2_stream_verify_t hr_and_spo2_stream_verify = {0};
+
+/**
+ * @brief Verify function.
+ * @details This function calculates the values of the window with the
+ * original two-call path and counts a mismatch if any value or error
+ * differs from the evaluation.
+ */
+static void verify_result(uint32 *ir_window, uint32 *red_window, uint16 n_size, oximeter5_analysis_t *result){
+    uint8 spo2;
+    sint32 heart_rate;
+
+    oximeter5_return_value_t spo2_error = oximeter5_get_oxygen_saturation(ir_window, n_size, red_window, &spo2);
+    oximeter5_return_value_t heart_rate_error = oximeter5_get_heart_rate(ir_window, n_size, red_window, &heart_rate);
+
+    hr_and_spo2_stream_verify.runs++;
+    if(spo2 != result->spo2 || spo2_error != result->spo2_error ||
+       heart_rate != result->heart_rate || heart_rate_error != result->heart_rate_error){
+        hr_and_spo2_stream_verify.mismatches++;
+        hr_and_spo2_stream_verify.stream_heart_rate = result->heart_rate;
+        hr_and_spo2_stream_verify.reference_heart_rate = heart_rate;
+        hr_and_spo2_stream_verify.stream_spo2 = result->spo2;
+        hr_and_spo2_stream_verify.reference_spo2 = spo2;
+    }
+}
+#endif
+
+/**
+ * @brief Signal value function.
+ * @details This function returns one value of the DC-removed, inverted and
+ * smoothed IR signal of the window, calculated like oximeter5_analyze_window.
+ */
+static HR_AND_SPO2_DSP_CODE sint32 signal_value(hr_and_spo2_stream_t *stream, sint32 ir_mean, sint32 n_size, sint32 n_cnt){
+    // the last samples have no complete average
+    if(n_cnt < n_size - MA4_SIZE)
+        return (MA4_SIZE * ir_mean - (sint32)stream->ma4_sum[stream->head + n_cnt]) / MA4_SIZE;
+    return ir_mean - (sint32)stream->ir[stream->head + n_cnt];
+}
+
+/**
+ * @brief Threshold limit function.
+ * @details This function limits the mean of the signal to the allowed threshold range.
+ */
+static HR_AND_SPO2_DSP_CODE sint32 limit_threshold(sint32 n_sum, sint32 n_size){
+    sint32 n_th1 = n_sum / n_size;
+
+    if(n_th1 < OXIMETER5_MIN_THRESHOLD)
+        n_th1 = OXIMETER5_MIN_THRESHOLD;
+    if(n_th1 > OXIMETER5_MAX_THRESHOLD)
+        n_th1 = OXIMETER5_MAX_THRESHOLD;
+    return n_th1;
+}
+
+/**
+ * @brief Threshold function.
+ * @details This function calculates the valley detection threshold of the
+ * window. The sum of the smoothed values is known from the IR sum up to the
+ * truncation of each value, which is less than 1. Only if that uncertainty
+ * reaches across a threshold step the values are summed one by one.
+ */
+static HR_AND_SPO2_DSP_CODE sint32 calc_threshold(hr_and_spo2_stream_t *stream, sint32 ir_mean, sint32 n_size){
+    uint32 *ir_window = &stream->ir[stream->head];
+    sint32 n_smoothed = n_size - MA4_SIZE;
+    sint32 n_tail_sum = 0;
+
+    // every sample is part of MA4_SIZE moving average sums except the first and last ones
+    sint32 n_ma4_total = MA4_SIZE * (sint32)stream->ir_sum;
+    for(sint32 n_cnt = 0; n_cnt < MA4_SIZE - 1; n_cnt++)
+        n_ma4_total -= (MA4_SIZE - 1 - n_cnt) * (sint32)ir_window[n_cnt];
+    for(sint32 n_cnt = 1; n_cnt <= MA4_SIZE; n_cnt++)
+        n_ma4_total -= n_cnt * (sint32)ir_window[n_smoothed - 1 + n_cnt];
+
+    for(sint32 n_cnt = n_smoothed; n_cnt < n_size; n_cnt++)
+        n_tail_sum += ir_mean - (sint32)ir_window[n_cnt];
+
+    // bounds of the sum of the truncated smoothed values
+    sint32 n_dc_sum = n_smoothed * MA4_SIZE * ir_mean - n_ma4_total;
+    sint32 n_sum_min = (n_dc_sum - (MA4_SIZE - 1) * n_smoothed) / MA4_SIZE - 1 + n_tail_sum;
+    sint32 n_sum_max = (n_dc_sum + (MA4_SIZE - 1) * n_smoothed) / MA4_SIZE + 1 + n_tail_sum;
+
+    sint32 n_th1 = limit_threshold(n_sum_min, n_size);
+    if(n_th1 == limit_threshold(n_sum_max, n_size))
+        return n_th1;
+
+    sint32 n_sum = n_tail_sum;
+    for(sint32 n_cnt = 0; n_cnt < n_smoothed; n_cnt++)
+        n_sum += signal_value(stream, ir_mean, n_size, n_cnt);
+    return limit_threshold(n_sum, n_size);
+}
+
+/**
+ * @brief Valley check function.
+ * @details This function finds the plateau of the signal containing n_cnt
+ * and adds its start to the valleys if it ends before n_end_max and is a
+ * valley above the threshold, like the peak detector of
+ * oximeter5_find_valleys does.
+ * @return End of the plateau.
+ */
+static HR_AND_SPO2_DSP_CODE sint32 check_valley(hr_and_spo2_stream_t *stream, sint32 ir_mean, sint32 n_size, sint32 n_cnt,
+                                                sint32 n_end_max, sint32 n_th1, oximeter5_analysis_t *result){
+    sint32 n_value = signal_value(stream, ir_mean, n_size, n_cnt);
+    sint32 n_start = n_cnt;
+    sint32 n_end = n_cnt;
+
+    while(n_start > 0 && signal_value(stream, ir_mean, n_size, n_start - 1) == n_value)
+        n_start--;
+    while(n_end + 1 < n_size && signal_value(stream, ir_mean, n_size, n_end + 1) == n_value)
+        n_end++;
+
+    // a plateau at the start or end of the window is not a valley
+    if(n_value > n_th1 && n_start > 0 && n_end < n_end_max && n_end + 1 < n_size && result->valley_count < OXIMETER5_MAX_VALLEYS &&
+       signal_value(stream, ir_mean, n_size, n_start - 1) < n_value &&
+       signal_value(stream, ir_mean, n_size, n_end + 1) < n_value){
+        stream->an_x[n_start] = n_value;
+        result->valley_locs[result->valley_count++] = n_start;
+    }
+    return n_end;
+}
+
+void hr_and_spo2_stream_init(hr_and_spo2_stream_t *stream){
+    stream->ir_sum = 0;
+    stream->ma4_running_sum = 0;
+    stream->index = 0;
+    stream->falling = FALSE;
+    stream->head = 0;
+    stream->count = 0;
+    stream->candidate_head = 0;
+    stream->candidate_count = 0;
+    stream->beat_count = 0;
+}
+
+void hr_and_spo2_stream_push(hr_and_spo2_stream_t *stream, uint32 ir, uint32 red){
+    // position of the new sample, the oldest sample is overwritten if the window is full
+    uint16 pos = stream->head + stream->count;
+    if(pos >= BUFFER_SIZE)
+        pos -= BUFFER_SIZE;
+
+    if(stream->count == BUFFER_SIZE){
+        stream->ir_sum -= stream->ir[pos];
+        stream->head = (stream->head + 1 == BUFFER_SIZE) ? 0 : stream->head + 1;
+    }
+    else{
+        stream->count++;
+    }
+    stream->index++;
+
+    // drop the sample leaving the moving average, the mirror keeps pos + BUFFER_SIZE - MA4_SIZE valid
+    if(stream->count > MA4_SIZE)
+        stream->ma4_running_sum -= stream->ir[pos + BUFFER_SIZE - MA4_SIZE];
+
+    // store sample at both mirrored positions
+    stream->ir[pos] = ir;
+    stream->ir[pos + BUFFER_SIZE] = ir;
+    stream->red[pos] = red;
+    stream->red[pos + BUFFER_SIZE] = red;
+
+    stream->ir_sum += ir;
+    stream->ma4_running_sum += ir;
+
+    // moving average of the sample MA4_SIZE - 1 positions back is complete now
+    if(stream->count >= MA4_SIZE){
+        uint16 ma4_pos = pos + BUFFER_SIZE - (MA4_SIZE - 1);
+        if(ma4_pos >= BUFFER_SIZE)
+            ma4_pos -= BUFFER_SIZE;
+        stream->ma4_sum[ma4_pos] = stream->ma4_running_sum;
+        stream->ma4_sum[ma4_pos + BUFFER_SIZE] = stream->ma4_running_sum;
+
+        // a plateau of the sums that was entered by a fall and is left by a rise is a valley candidate
+        uint32 ma4_index = stream->index - MA4_SIZE;
+        if(stream->count > MA4_SIZE){
+            uint32 previous = stream->ma4_sum[ma4_pos + BUFFER_SIZE - 1];
+            if(stream->ma4_running_sum < previous){
+                stream->minimum_start = ma4_index;
+                stream->falling = TRUE;
+            }
+            else if(stream->ma4_running_sum > previous){
+                if(stream->falling){
+                    uint16 candidate_pos = stream->candidate_head + stream->candidate_count;
+                    if(candidate_pos >= HR_AND_SPO2_STREAM_CANDIDATES)
+                        candidate_pos -= HR_AND_SPO2_STREAM_CANDIDATES;
+                    stream->candidates[candidate_pos] = stream->minimum_start;
+                    if(stream->candidate_count < HR_AND_SPO2_STREAM_CANDIDATES)
+                        stream->candidate_count++;
+                    else
+                        stream->candidate_head = (candidate_pos + 1 == HR_AND_SPO2_STREAM_CANDIDATES) ? 0 : candidate_pos + 1;
+                }
+                stream->falling = FALSE;
+            }
+        }
+    }
+
+    // drop the candidates that left the window, the first sample cannot be a valley
+    uint32 first_index = stream->index - stream->count;
+    while(stream->candidate_count > 0 && (sint32)(stream->candidates[stream->candidate_head] - first_index) < 1){
+        stream->candidate_head = (stream->candidate_head + 1 == HR_AND_SPO2_STREAM_CANDIDATES) ? 0 : stream->candidate_head + 1;
+        stream->candidate_count--;
+    }
+}
+
+HR_AND_SPO2_DSP_CODE oximeter5_return_value_t hr_and_spo2_stream_evaluate(hr_and_spo2_stream_t *stream, oximeter5_analysis_t *result){
+    // calculation needs enough samples for the moving average and a few beats
+    if(stream->count < HR_AND_SPO2_STREAM_MIN_SAMPLES){
+        result->spo2 = OXIMETER5_PN_SPO2_ERROR_DATA;
+        result->heart_rate = OXIMETER5_HEART_RATE_ERROR_DATA;
+        result->spo2_error = OXIMETER5_ERROR;
+        result->heart_rate_error = OXIMETER5_ERROR;
+        result->valley_count = 0;
+        return OXIMETER5_ERROR;
+    }
+
+    // contiguous view of the window thanks to the mirrored storage, a window that is not full starts at index 0
+    sint32 n_size = stream->count;
+    uint32 first_index = stream->index - stream->count;
+    uint32 *ir_window = &stream->ir[stream->head];
+    uint32 *red_window = &stream->red[stream->head];
+    sint32 ir_mean = (sint32)(stream->ir_sum / n_size);
+
+    PROFILE_BEGIN(PROFILE_STREAM_EVALUATE);
+    result->ir_mean = (uint32)ir_mean;
+    result->threshold = calc_threshold(stream, ir_mean, n_size);
+
+    for(sint32 n_cnt = 0; n_cnt < OXIMETER5_MAX_VALLEYS; n_cnt++)
+        result->valley_locs[n_cnt] = 0;
+    result->valley_count = 0;
+
+    // valleys ending before the last samples contain a candidate, each plateau is checked once
+    sint32 n_tail = n_size - MA4_SIZE - 2;
+    sint32 n_end = 0;
+    for(uint16 n_cnt = 0; n_cnt < stream->candidate_count; n_cnt++){
+        uint16 candidate_pos = stream->candidate_head + n_cnt;
+        if(candidate_pos >= HR_AND_SPO2_STREAM_CANDIDATES)
+            candidate_pos -= HR_AND_SPO2_STREAM_CANDIDATES;
+        sint32 n_loc = (sint32)(stream->candidates[candidate_pos] - first_index);
+
+        if(n_loc >= n_tail)
+            break;
+        if(n_loc <= n_end)
+            continue;
+        // a plateau reaching into the last samples is left to their scan
+        n_end = check_valley(stream, ir_mean, n_size, n_loc, n_tail, result->threshold, result);
+    }
+
+    // the last samples do not use the moving average, their valleys are searched by the plateau end
+    for(sint32 n_cnt = n_tail; n_cnt < n_size - 1; n_cnt++){
+        if(signal_value(stream, ir_mean, n_size, n_cnt + 1) < signal_value(stream, ir_mean, n_size, n_cnt))
+            check_valley(stream, ir_mean, n_size, n_cnt, n_size, result->threshold, result);
+    }
+
+    oximeter5_select_valleys(stream->an_x, result->valley_locs, &result->valley_count);
+    result->heart_rate_error = oximeter5_calc_heart_rate(result->valley_locs, result->valley_count, &result->heart_rate);
+
+    // the ratio of a beat only depends on its samples, beats of the last evaluation are not scanned again
+    hr_and_spo2_stream_beat_t beats[OXIMETER5_MAX_VALLEYS - 1];
+    sint32 an_ratio[OXIMETER5_MAX_RATIOS] = {0};
+    uint16 beat_count = 0;
+    result->ratio_count = 0;
+    for(sint32 n_cnt = 0; n_cnt < result->valley_count - 1 && result->ratio_count < OXIMETER5_MAX_RATIOS; n_cnt++){
+        hr_and_spo2_stream_beat_t *beat = &beats[beat_count++];
+        beat->start = first_index + (uint32)result->valley_locs[n_cnt];
+        beat->end = first_index + (uint32)result->valley_locs[n_cnt + 1];
+
+        uint16 n_old = 0;
+        while(n_old < stream->beat_count && (stream->beats[n_old].start != beat->start || stream->beats[n_old].end != beat->end))
+            n_old++;
+        if(n_old < stream->beat_count)
+            *beat = stream->beats[n_old];
+        else
+            beat->valid = oximeter5_calc_valley_ratio(ir_window, red_window, result->valley_locs[n_cnt],
+                                                      result->valley_locs[n_cnt + 1], &beat->ratio);
+
+        if(beat->valid)
+            an_ratio[result->ratio_count++] = beat->ratio;
+    }
+    for(uint16 n_cnt = 0; n_cnt < beat_count; n_cnt++)
+        stream->beats[n_cnt] = beats[n_cnt];
+    stream->beat_count = beat_count;
+
+    result->spo2_error = oximeter5_calc_spo2_from_ratios(an_ratio, result->ratio_count, &result->spo2, &result->ratio_average);
+    oximeter5_return_value_t error_flag = result->heart_rate_error | result->spo2_error;
+    PROFILE_END(PROFILE_STREAM_EVALUATE);
+
+#if HR_AND_SPO2_STREAM_VERIFY
+    verify_result(ir_window, red_window, n_size, result);
+#endif
+
+    return error_flag;
+}
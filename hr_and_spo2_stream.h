@@ -0,0 +1,140 @@
+/*
+ * hr_and_spo2_stream.h
+ *
+ *  Created on: 17.10.2026
+ *      Author: Andreas Reichenauer
+ */
+
+/*!
+ * @file hr_and_spo2_stream.h
+ * @brief This file contains the streaming sample window used for the heart rate and SpO2 calculation.
+ */
+
+#ifndef HR_AND_SPO2_STREAM_H_
+#define HR_AND_SPO2_STREAM_H_
+
+#include "oximeter5_click.h"
+
+// min number of samples for a provisional evaluation of a window that is not full yet
+#define HR_AND_SPO2_STREAM_MIN_SAMPLES      SAMPLING_FREQUENCY
+// set to 1 to check every evaluation against oximeter5_get_oxygen_saturation and oximeter5_get_heart_rate
+#define HR_AND_SPO2_STREAM_VERIFY           0
+// max number of valley candidates in the window, two minima are at least two samples apart
+#define HR_AND_SPO2_STREAM_CANDIDATES       ( BUFFER_SIZE / 2 )
+
+/**
+ * @brief Streaming window beat object.
+ * @details AC/DC ratio of the samples between two consecutive valleys.
+ */
+typedef struct
+{
+    uint32 start;       /**< Sample index of the first valley. */
+    uint32 end;         /**< Sample index of the next valley. */
+    sint32 ratio;       /**< AC/DC ratio X100, only set if valid. */
+    boolean valid;      /**< TRUE if the beat gives a ratio. */
+
+} hr_and_spo2_stream_beat_t;
+
+/**
+ * @brief Streaming sample window object.
+ * @details Ring buffer of the last #BUFFER_SIZE IR and red samples. Every
+ * sample is stored twice (at index i and i + #BUFFER_SIZE), so the window
+ * starting at @c head is always one contiguous array and can be handed to
+ * the calculation functions without shifting or copying it. The running IR
+ * sum and the 4 point sums of the moving average are updated per sample.
+ *
+ * The valley candidates are tracked per sample as well: every minimum of
+ * the moving average sums is stored with its sample index. The smoothed
+ * signal is the window mean minus these sums, truncated, so a valley of it
+ * always contains such a minimum, and an evaluation only checks the
+ * candidates and the last samples, whose values use the raw IR samples
+ * instead of the moving average. The threshold is bounded from the sums and
+ * only summed over the window if the truncation can change it. The AC/DC
+ * ratio of a beat only depends on its own samples and is kept while both of
+ * its valleys stay the same, so only new beats are scanned. The results are
+ * still exactly the ones of the two-call path.
+ */
+typedef struct
+{
+    uint32 ir[ 2 * BUFFER_SIZE ];       /**< Mirrored IR samples. */
+    uint32 red[ 2 * BUFFER_SIZE ];      /**< Mirrored red samples. */
+    uint32 ma4_sum[ 2 * BUFFER_SIZE ];  /**< Mirrored sums of MA4_SIZE IR samples, starting at the same index. */
+    sint32 an_x[ BUFFER_SIZE ];         /**< DC-removed, inverted and smoothed IR signal, only set at the valleys of the last evaluation. */
+    uint32 candidates[ HR_AND_SPO2_STREAM_CANDIDATES ];     /**< Sample indices of the moving average minima, ring buffer. */
+    hr_and_spo2_stream_beat_t beats[ OXIMETER5_MAX_VALLEYS - 1 ];   /**< Beats of the last evaluation. */
+    uint32 ir_sum;                      /**< Sum of all IR samples in the window. */
+    uint32 ma4_running_sum;             /**< Sum of the last MA4_SIZE IR samples. */
+    uint32 index;                       /**< Sample index of the next sample, counts all pushed samples. */
+    uint32 minimum_start;               /**< Sample index of the moving average plateau after the last fall. */
+    boolean falling;                    /**< TRUE if the moving average fell and has not risen since. */
+    uint16 head;                        /**< Index of the oldest sample. */
+    uint16 count;                       /**< Number of samples in the window. */
+    uint16 candidate_head;              /**< Index of the oldest candidate. */
+    uint16 candidate_count;             /**< Number of candidates. */
+    uint16 beat_count;                  /**< Number of beats of the last evaluation. */
+
+} hr_and_spo2_stream_t;
+
+#if HR_AND_SPO2_STREAM_VERIFY
+/**
+ * @brief Stream verification data.
+ * @details Comparison of the evaluations with the two-call path on the same window.
+ */
+typedef struct
+{
+    uint32 runs;                    /**< Number of compared evaluations. */
+    uint32 mismatches;              /**< Evaluations with a different value or error. */
+    sint32 stream_heart_rate;       /**< Heart rate of the stream at the last mismatch. */
+    sint32 reference_heart_rate;    /**< Heart rate of oximeter5_get_heart_rate at the last mismatch. */
+    uint8 stream_spo2;              /**< SpO2 of the stream at the last mismatch. */
+    uint8 reference_spo2;           /**< SpO2 of oximeter5_get_oxygen_saturation at the last mismatch. */
+
+} hr_and_spo2_stream_verify_t;
+
+extern hr_and_spo2_stream_verify_t hr_and_spo2_stream_verify;
+#endif
+
+/**
+ * @brief Streaming window initialization function.
+ * @details This function empties the sample window.
+ * @param[out] stream : Streaming window object.
+ * @return Nothing.
+ * @note None.
+ */
+void hr_and_spo2_stream_init(hr_and_spo2_stream_t *stream);
+
+/**
+ * @brief Streaming window push function.
+ * @details This function appends one sample to the window. If the window
+ * is full the oldest sample is dropped. The cost is constant per sample,
+ * amortized over the candidates leaving the window.
+ * @param[in,out] stream : Streaming window object.
+ * @param[in] ir : IR sample.
+ * @param[in] red : Red sample.
+ * @return Nothing.
+ * @note None.
+ */
+void hr_and_spo2_stream_push(hr_and_spo2_stream_t *stream, uint32 ir, uint32 red);
+
+/**
+ * @brief Streaming window evaluation function.
+ * @details This function calculates the SpO2 and heart rate values of the
+ * current window. The results are the same as the ones of
+ * #oximeter5_get_oxygen_saturation and #oximeter5_get_heart_rate called on
+ * the same samples, which #HR_AND_SPO2_STREAM_VERIFY checks on the target.
+ * The cost grows with the number of valley candidates and new beats, not
+ * with the window length, see #hr_and_spo2_stream_t. A window that is not full yet is evaluated as well once
+ * it holds #HR_AND_SPO2_STREAM_MIN_SAMPLES samples, the result is
+ * provisional then and converges to the full window result.
+ * @param[in,out] stream : Streaming window object.
+ * @param[out] result : Analysis result of the window.
+ * See #oximeter5_analysis_t object definition for detailed explanation.
+ * @return @li @c  0 - Success,
+ *         @li @c -1 - Error, too few samples or values could not be calculated.
+ *
+ * See #oximeter5_return_value_t definition for detailed explanation.
+ * @note None.
+ */
+oximeter5_return_value_t hr_and_spo2_stream_evaluate(hr_and_spo2_stream_t *stream, oximeter5_analysis_t *result);
+
+#endif /* HR_AND_SPO2_STREAM_H_ */
@@ -0,0 +1,316 @@
+/*
+ * i2c_job_queue.c
+ *
+ *  Created on: 17.10.2026
+ *      Author: Andreas Reichenauer
+ */
+
+/*!
+ * @file i2c_job_queue.c
+ * @brief This file implements the interrupt driven transfer queue layered on the IfxI2c_I2c driver.
+ */
+
+#include <IfxSrc.h>
+#include <i2c_job_queue.h>
+
+/*************************************************************************************************************/
+/*------------------------------------------------------Macros-----------------------------------------------*/
+/*************************************************************************************************************/
+#define ISR_PRIORITY_I2C_PROTOCOL     7        // Interrupt priority for I2C protocol events, above the sensor interrupts
+#define ISR_PRIORITY_I2C_ERROR        8        // Interrupt priority for I2C errors
+
+/*************************************************************************************************************/
+/*-------------------------------------------------Type Definitions------------------------------------------*/
+/*************************************************************************************************************/
+typedef enum
+{
+    I2C_STATE_IDLE = 0,     // no job active
+    I2C_STATE_SEND_REG,     // register address of a read job is sent
+    I2C_STATE_RECEIVE,      // data of a read job is received after the repeated start
+    I2C_STATE_SEND_DATA,    // register address and data of a write job are sent
+    I2C_STATE_STOP          // stop condition is sent
+
+} i2c_state_t;
+
+/*************************************************************************************************************/
+/*-------------------------------------------------Global variables------------------------------------------*/
+/*************************************************************************************************************/
+static IfxI2c_I2c *i2c_handle = NULL_PTR;                 // I2C handle used for all jobs
+static i2c_job_t *job_queue[I2C_JOB_QUEUE_LENGTH];        // Ring buffer of submitted jobs, the first one is active
+static uint8 queue_head = 0;                              // Index of the active job
+static uint8 queue_count = 0;                             // Number of submitted jobs
+static volatile i2c_state_t i2c_state = I2C_STATE_IDLE;   // State of the active job
+static IfxDma_Dma_Channel rx_dma_channel;                 // DMA channel moving received words into the read buffer
+
+/*********************************************************************************************************************/
+/*---------------------------------------------Function Implementations----------------------------------------------*/
+/*********************************************************************************************************************/
+IFX_INTERRUPT(interruptI2cProtocol, 1, ISR_PRIORITY_I2C_PROTOCOL);  // Adding the protocol Interrupt Service Routine
+IFX_INTERRUPT(interruptI2cError, 1, ISR_PRIORITY_I2C_ERROR);        // Adding the error Interrupt Service Routine
+
+
+/**
+ * @brief Clear FIFO requests function.
+ * @details This function clears all pending single and burst request flags.
+ */
+static void clear_requests(Ifx_I2C *i2c){
+    IfxI2c_clearLastSingleRequestInterruptSource(i2c);
+    IfxI2c_clearSingleRequestInterruptSource(i2c);
+    IfxI2c_clearLastBurstRequestInterruptSource(i2c);
+    IfxI2c_clearBurstRequestInterruptSource(i2c);
+}
+
+
+/**
+ * @brief Send stop function.
+ * @details This function ends the transfer, the end of the stop condition
+ * raises another transmission end event.
+ */
+static void send_stop(Ifx_I2C *i2c){
+    i2c_state = I2C_STATE_STOP;
+    i2c->ENDDCTRL.B.SETEND = 1;
+}
+
+
+/**
+ * @brief DMA address function.
+ * @details This function returns the address of a read buffer as seen by the DMA. Only a local DSPR address
+ * (segment 0xD) is translated, into the global DSPR alias of this core. The jobs are submitted on the core
+ * which services the I2C interrupts, so this core is the owner of a local buffer. Global DSPR, LMU and any
+ * other addresses are already valid for the DMA and are passed through.
+ */
+static uint32 dma_address(uint8 *buffer){
+    uint32 address = (uint32)buffer;
+
+    if((address & 0xF0000000) == 0xD0000000)
+        return IFXCPU_GLB_ADDR_DSPR(IfxCpu_getCoreId(), address);
+
+    return address;
+}
+
+
+/**
+ * @brief Start job function.
+ * @details This function sends the first packet of the active job.
+ */
+static void start_job(i2c_job_t *job){
+    Ifx_I2C *i2c = i2c_handle->i2c;
+    uint8 sl_addr = job->device->deviceAddress;
+
+    IfxI2c_clearAllProtocolInterruptSources(i2c);
+    IfxI2c_clearAllErrorInterruptSources(i2c);
+
+    if(job->type == I2C_JOB_READ){
+        // slave address and register, the module keeps the bus after the packet (ADDRCFG.SOPE = 0)
+        IfxI2c_setTransmitPacketSize(i2c, 2);
+        IfxI2c_writeFifo(i2c, (uint32)sl_addr | ((uint32)job->reg << 8));
+        i2c_state = I2C_STATE_SEND_REG;
+    }
+    else{
+        // slave address, register and data in one packet, it fits into the FIFO
+        uint8 packet_len = job->len + 2;
+        uint32 tx_word = 0;
+
+        IfxI2c_setTransmitPacketSize(i2c, packet_len);
+        for(uint8 n_cnt = 0; n_cnt < packet_len; n_cnt++){
+            uint8 tx_byte = (n_cnt == 0) ? sl_addr : (n_cnt == 1) ? job->reg : job->data[n_cnt - 2];
+            tx_word |= (uint32)tx_byte << (8 * (n_cnt % 4));
+            if(n_cnt % 4 == 3 || n_cnt == packet_len - 1){
+                IfxI2c_writeFifo(i2c, tx_word);
+                tx_word = 0;
+            }
+        }
+        i2c_state = I2C_STATE_SEND_DATA;
+    }
+
+    clear_requests(i2c);
+}
+
+
+/**
+ * @brief Finish job function.
+ * @details This function retries the active job if the device did not
+ * acknowledge and retries are left. Otherwise it removes the job from the
+ * queue, calls its callback and starts the next job.
+ */
+static void finish_job(void){
+    i2c_job_t *job = job_queue[queue_head];
+
+    if((job->status == IfxI2c_I2c_Status_nak || job->status == IfxI2c_I2c_Status_al) && job->retries > 0){
+        job->retries--;
+        job->status = IfxI2c_I2c_Status_ok;
+        start_job(job);
+        return;
+    }
+
+    queue_head = (queue_head + 1) % I2C_JOB_QUEUE_LENGTH;
+    queue_count--;
+    i2c_state = I2C_STATE_IDLE;
+
+    // the callback may submit follow-up jobs, they are appended behind the waiting ones
+    if(job->callback != NULL)
+        job->callback(job);
+
+    if(i2c_state == I2C_STATE_IDLE && queue_count > 0)
+        start_job(job_queue[queue_head]);
+}
+
+
+void interruptI2cProtocol(void)
+{
+    Ifx_I2C *i2c = i2c_handle->i2c;
+    i2c_job_t *job = job_queue[queue_head];
+
+    if(i2c_state == I2C_STATE_IDLE) return;                              // Events of blocking transfers are left to them
+
+    uint32 events = i2c->PIRQSS.U;
+    i2c->PIRQSC.U = events;                                              // Clear the protocol events
+
+    if(i2c_state == I2C_STATE_STOP){
+        // bus is released
+        if(events & (1 << IfxI2c_ProtocolInterruptSource_transmissionEnd))
+            finish_job();
+        return;
+    }
+
+    if(events & (1 << IfxI2c_ProtocolInterruptSource_arbitrationLost)){
+        job->status = IfxI2c_I2c_Status_al;
+        send_stop(i2c);
+    }
+    else if(events & (1 << IfxI2c_ProtocolInterruptSource_notAcknowledgeReceived)){
+        job->status = IfxI2c_I2c_Status_nak;
+        send_stop(i2c);
+    }
+    else if(events & (1 << IfxI2c_ProtocolInterruptSource_transmissionEnd)){
+        if(i2c_state == I2C_STATE_SEND_REG){
+            // repeated start with the read bit set
+            IfxI2c_setTransmitPacketSize(i2c, 1);
+            IfxI2c_setReceivePacketSize(i2c, job->len);
+            // received words are moved by the DMA on each single request
+            IfxDma_Dma_setChannelDestinationAddress(&rx_dma_channel, dma_address(job->data));
+            IfxDma_Dma_setChannelTransferCount(&rx_dma_channel, (job->len + 3) / 4);
+            IfxDma_enableChannelTransaction(rx_dma_channel.dma, rx_dma_channel.channelId);
+
+            IfxI2c_writeFifo(i2c, (uint32)job->device->deviceAddress | 1);
+            clear_requests(i2c);
+            i2c_state = I2C_STATE_RECEIVE;
+        }
+        else if(i2c_state == I2C_STATE_RECEIVE){
+            // words signaled by the last single request are not moved by the DMA and are still in the FIFO
+            IfxDma_disableChannelTransaction(rx_dma_channel.dma, rx_dma_channel.channelId);
+            uint8 n_moved = (job->len + 3) / 4 - IfxDma_getChannelTransferCount(rx_dma_channel.dma, rx_dma_channel.channelId);
+
+            // the first byte is in the lowest byte of a word
+            for(uint8 n_cnt = 4 * n_moved; n_cnt < job->len; n_cnt += 4){
+                uint32 rx_word = i2c->RXD.U;
+                for(uint8 n_byte = 0; n_byte < 4 && n_cnt + n_byte < job->len; n_byte++)
+                    job->data[n_cnt + n_byte] = (uint8)(rx_word >> (8 * n_byte));
+            }
+            clear_requests(i2c);
+            send_stop(i2c);
+        }
+        else{
+            send_stop(i2c);
+        }
+    }
+}
+
+
+void interruptI2cError(void)
+{
+    Ifx_I2C *i2c = i2c_handle->i2c;
+
+    if(i2c_state == I2C_STATE_IDLE) return;                              // Errors of blocking transfers are left to them
+
+    IfxI2c_clearAllErrorInterruptSources(i2c);                           // Clear the error events
+
+    if(i2c_state == I2C_STATE_STOP) return;
+
+    IfxDma_disableChannelTransaction(rx_dma_channel.dma, rx_dma_channel.channelId);
+    job_queue[queue_head]->status = IfxI2c_I2c_Status_error;
+    send_stop(i2c);
+}
+
+
+void init_i2c_job_queue(IfxI2c_I2c *i2c){
+    Ifx_I2C *i2c_sfr = i2c->i2c;
+
+    i2c_handle = i2c;
+    queue_head = 0;
+    queue_count = 0;
+    i2c_state = I2C_STATE_IDLE;
+
+    // protocol events of a master transfer and all FIFO errors raise interrupts
+    IfxI2c_enableProtocolInterruptSource(i2c_sfr, IfxI2c_ProtocolInterruptSource_transmissionEnd);
+    IfxI2c_enableProtocolInterruptSource(i2c_sfr, IfxI2c_ProtocolInterruptSource_notAcknowledgeReceived);
+    IfxI2c_enableProtocolInterruptSource(i2c_sfr, IfxI2c_ProtocolInterruptSource_arbitrationLost);
+    IfxI2c_enableProtocolInterruptFlag(i2c_sfr);
+    IfxI2c_enableErrorInterruptSource(i2c_sfr, IfxI2c_ErrorInterruptSource_rxFifoOverflow);
+    IfxI2c_enableErrorInterruptSource(i2c_sfr, IfxI2c_ErrorInterruptSource_rxFifoUnderflow);
+    IfxI2c_enableErrorInterruptSource(i2c_sfr, IfxI2c_ErrorInterruptSource_txFifoOverflow);
+    IfxI2c_enableErrorInterruptSource(i2c_sfr, IfxI2c_ErrorInterruptSource_txFifoUnderflow);
+    IfxI2c_enableErrorInterruptFlag(i2c_sfr);
+
+    volatile Ifx_SRC_SRCR *src = IfxI2c_getProtocolSrcPointer(i2c_sfr);
+    IfxSrc_init(src, IfxSrc_Tos_cpu1, ISR_PRIORITY_I2C_PROTOCOL);
+    IfxSrc_enable(src);
+
+    src = IfxI2c_getErrorSrcPointer(i2c_sfr);
+    IfxSrc_init(src, IfxSrc_Tos_cpu1, ISR_PRIORITY_I2C_ERROR);
+    IfxSrc_enable(src);
+
+    // DMA channel moving one word from the RX FIFO per single request, the source address stays on RXD
+    IfxDma_Dma dma;
+    IfxDma_Dma_createModuleHandle(&dma, &MODULE_DMA);
+
+    IfxDma_Dma_ChannelConfig dma_config;
+    IfxDma_Dma_initChannelConfig(&dma_config, &dma);
+    dma_config.channelId                            = I2C_RX_DMA_CHANNEL;
+    dma_config.hardwareRequestEnabled               = FALSE;                    // Enabled for each read job
+    dma_config.requestMode                          = IfxDma_ChannelRequestMode_oneTransferPerRequest;
+    dma_config.operationMode                        = IfxDma_ChannelOperationMode_single;
+    dma_config.moveSize                             = IfxDma_ChannelMoveSize_32bit;
+    dma_config.blockMode                            = IfxDma_ChannelMove_1;
+    dma_config.transferCount                        = 1;
+    dma_config.sourceAddress                        = (uint32)&i2c_sfr->RXD.U;
+    dma_config.sourceCircularBufferEnabled          = TRUE;
+    dma_config.sourceAddressCircularRange           = IfxDma_ChannelIncrementCircular_none;
+    dma_config.destinationAddressIncrementStep      = IfxDma_ChannelIncrementStep_1;
+    dma_config.destinationAddressIncrementDirection = IfxDma_ChannelIncrementDirection_positive;
+    IfxDma_Dma_initChannel(&rx_dma_channel, &dma_config);
+
+    // single requests of the I2C module trigger the DMA channel
+    src = IfxI2c_getSingleDataTransferSrcPointer(i2c_sfr);
+    IfxSrc_init(src, IfxSrc_Tos_dma, (Ifx_Priority)I2C_RX_DMA_CHANNEL);
+    IfxSrc_enable(src);
+    IfxI2c_enableSingleRequestInterruptSource(i2c_sfr);
+}
+
+
+boolean submit_i2c_job(i2c_job_t *job){
+    if((job->type == I2C_JOB_WRITE && job->len > I2C_JOB_MAX_WRITE_LEN) || (job->type == I2C_JOB_READ && job->len == 0))
+        return FALSE;
+
+    boolean int_enabled = IfxCpu_disableInterrupts();                    // Queue is shared with the interrupts
+
+    if(queue_count == I2C_JOB_QUEUE_LENGTH){
+        IfxCpu_restoreInterrupts(int_enabled);
+        return FALSE;
+    }
+
+    job->status = IfxI2c_I2c_Status_ok;
+    job_queue[(queue_head + queue_count) % I2C_JOB_QUEUE_LENGTH] = job;
+    queue_count++;
+
+    // start at once if no job is active, otherwise the protocol interrupt starts it
+    if(i2c_state == I2C_STATE_IDLE)
+        start_job(job_queue[queue_head]);
+
+    IfxCpu_restoreInterrupts(int_enabled);
+    return TRUE;
+}
+
+
+boolean i2c_job_queue_idle(void){
+    return queue_count == 0;
+}
@@ -0,0 +1,111 @@
+/*
+ * i2c_job_queue.h
+ *
+ *  Created on: 17.10.2026
+ *      Author: Andreas Reichenauer
+ */
+
+/*!
+ * @file i2c_job_queue.h
+ * @brief This file contains the interrupt driven transfer queue layered on the IfxI2c_I2c driver.
+ */
+
+#ifndef I2C_JOB_QUEUE_H_
+#define I2C_JOB_QUEUE_H_
+
+#include <I2c/I2c/IfxI2c_I2c.h>
+#include <Dma/Dma/IfxDma_Dma.h>
+
+/*********************************************************************************************************************/
+/*------------------------------------------------------Macros-------------------------------------------------------*/
+/*********************************************************************************************************************/
+#define I2C_JOB_QUEUE_LENGTH        8       // Max number of submitted jobs
+#define I2C_JOB_MAX_WRITE_LEN       30      // Max number of data bytes of a write job, the packet is put into the 32 byte I2C FIFO at once
+#define I2C_JOB_DEFAULT_RETRIES     10      // Retries of a job the device did not acknowledge
+#define I2C_RX_DMA_CHANNEL          IfxDma_ChannelId_1  // DMA channel moving the received words of read jobs
+
+/*********************************************************************************************************************/
+/*---------------------------------------------Type Definitions------------------------------------------------------*/
+/*********************************************************************************************************************/
+/**
+ * @brief I2C job type.
+ * @details Both types first send the register address.
+ */
+typedef enum
+{
+    I2C_JOB_WRITE = 0,      /**< Write the data bytes after the register address. */
+    I2C_JOB_READ            /**< Read the data bytes after a repeated start. */
+
+} i2c_job_type_t;
+
+typedef struct i2c_job i2c_job_t;
+
+/**
+ * @brief I2C job completion callback.
+ * @details Called from the I2C protocol interrupt when the job is finished.
+ * The status of the job tells if it was successful.
+ */
+typedef void (*i2c_job_callback_t)(i2c_job_t *job);
+
+/**
+ * @brief I2C job object.
+ * @details The job is owned by the caller and must stay valid until its
+ * callback was called.
+ */
+struct i2c_job
+{
+    IfxI2c_I2c_Device *device;              /**< Slave device handle. */
+    i2c_job_type_t type;                    /**< Write or read. */
+    uint8 reg;                              /**< Start register address. */
+    uint8 *data;                            /**< Data to write or buffer for the read data, a read buffer must be word aligned and
+                                                 have room for @c len rounded up to whole words. */
+    uint8 len;                              /**< Number of data bytes, at most #I2C_JOB_MAX_WRITE_LEN for a write. A read has
+                                                 no limit of its own, the receive DMA empties the FIFO word by word and the
+                                                 module stretches the clock while the FIFO is full. */
+    uint8 retries;                          /**< Number of retries left if the device does not acknowledge. */
+    i2c_job_callback_t callback;            /**< Function called when the job is finished, may be NULL. */
+    void *arg;                              /**< Argument for the callback. */
+    volatile IfxI2c_I2c_Status status;      /**< Result of the job, valid in the callback. */
+};
+
+/*********************************************************************************************************************/
+/*---------------------------------------------Function Definitions--------------------------------------------------*/
+/*********************************************************************************************************************/
+/***
+ * @brief: interrupt handler called whenever an I2C protocol event (transmission end, NACK, arbitration lost) occurs
+ * @params: None
+ * @return: void
+ */
+void interruptI2cProtocol(void);
+
+/***
+ * @brief: interrupt handler called whenever an I2C error (FIFO over- or underflow) occurs
+ * @params: None
+ * @return: void
+ */
+void interruptI2cError(void);
+
+/***
+ * @brief: initialises the queue, the interrupts of the given I2C module and the receive DMA channel, the module has to
+ * be initialised already
+ * @params: IfxI2c_I2c *, I2C handle used for all jobs
+ * @returns: void
+ */
+void init_i2c_job_queue(IfxI2c_I2c *i2c);
+
+/***
+ * @brief: appends a job to the queue, the transfer is started at once if the queue is idle. Can be called from
+ * interrupts and from the callback of another job, but only on the core which services the I2C interrupts.
+ * @params: i2c_job_t *, job to transfer
+ * @returns: boolean, FALSE if the queue is full, a write job is too long or a read job is empty
+ */
+boolean submit_i2c_job(i2c_job_t *job);
+
+/***
+ * @brief: checks if all submitted jobs are finished, the blocking IfxI2c_I2c functions must only be used then
+ * @params: none
+ * @returns: boolean, TRUE if no job is pending
+ */
+boolean i2c_job_queue_idle(void);
+
+#endif /* I2C_JOB_QUEUE_H_ */
@@ -0,0 +1,108 @@
+/*
+ * measurement_ring.c
+ *
+ *  Created on: 17.10.2026
+ *      Author: Andreas Reichenauer
+ */
+
+/*!
+ * @file measurement_ring.c
+ * @brief This file implements the lock-free broadcast ring of timestamped measurements from CPU1 to the other cores.
+ */
+
+#include <IfxCpu.h>
+#include <measurement_ring.h>
+#include <memory_placement.h>
+#include <seqlock.h>
+
+/*************************************************************************************************************/
+/*-------------------------------------------------Type Definitions------------------------------------------*/
+/*************************************************************************************************************/
+typedef struct
+{
+    volatile uint32 lock;               // odd while the slot is written
+    volatile uint64 timestamp;
+    volatile uint32 sequence;
+    volatile sint32 heart_rate;
+    volatile uint8 spo2;
+    volatile uint8 quality;
+
+} measurement_slot_t;
+
+typedef struct
+{
+    volatile uint32 published;          // number of published records, sequence number of the next one
+    measurement_slot_t slots[MEASUREMENT_RING_LENGTH];
+
+} measurement_ring_t;
+
+/*************************************************************************************************************/
+/*-------------------------------------------------Global variables------------------------------------------*/
+/*************************************************************************************************************/
+// ring in the LMU, reachable by all cores without crossing the scratchpad of another core
+static measurement_ring_t ring_storage LMU_BSS;
+
+/*************************************************************************************************************/
+/*---------------------------------------------Function Implementations--------------------------------------*/
+/*************************************************************************************************************/
+static measurement_ring_t *get_ring(void){
+    // all accesses go through the non-cached segment
+    return (measurement_ring_t*)LMU_NON_CACHED(&ring_storage);
+}
+
+void measurement_ring_publish(measurement_t *measurement){
+    measurement_ring_t *ring = get_ring();
+    uint32 sequence = ring->published;
+    measurement_slot_t *slot = &ring->slots[sequence % MEASUREMENT_RING_LENGTH];
+
+    measurement->sequence = sequence;
+
+    uint32 lock = seqlock_write_begin(&slot->lock);
+
+    slot->timestamp = measurement->timestamp;
+    slot->sequence = sequence;
+    slot->heart_rate = measurement->heart_rate;
+    slot->spo2 = measurement->spo2;
+    slot->quality = measurement->quality;
+
+    // the slot is consistent again before the record is announced
+    seqlock_write_end(&slot->lock, lock);
+    __dsync();
+    ring->published = sequence + 1;
+}
+
+boolean measurement_ring_read(measurement_cursor_t *cursor, measurement_t *measurement){
+    measurement_ring_t *ring = get_ring();
+
+    while(1){
+        uint32 published = ring->published;
+        if(cursor->next_sequence == published)
+            return FALSE;
+
+        // skip the records which are overwritten already
+        if(published - cursor->next_sequence > MEASUREMENT_RING_LENGTH){
+            cursor->missed += published - MEASUREMENT_RING_LENGTH - cursor->next_sequence;
+            cursor->next_sequence = published - MEASUREMENT_RING_LENGTH;
+        }
+
+        measurement_slot_t *slot = &ring->slots[cursor->next_sequence % MEASUREMENT_RING_LENGTH];
+        uint32 lock;
+
+        do{
+            lock = seqlock_read_begin(&slot->lock);
+
+            measurement->timestamp = slot->timestamp;
+            measurement->sequence = slot->sequence;
+            measurement->heart_rate = slot->heart_rate;
+            measurement->spo2 = slot->spo2;
+            measurement->quality = slot->quality;
+        }while(seqlock_read_retry(&slot->lock, lock));
+
+        // the slot was overwritten by a newer record while it was read, count it on the next pass
+        if(measurement->sequence != cursor->next_sequence)
+            continue;
+
+        cursor->next_sequence++;
+        return TRUE;
+    }
+}
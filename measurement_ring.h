@@ -0,0 +1,80 @@
+/*
+ * measurement_ring.h
+ *
+ *  Created on: 17.10.2026
+ *      Author: Andreas Reichenauer
+ */
+
+/*!
+ * @file measurement_ring.h
+ * @brief This file contains the lock-free broadcast ring of timestamped measurements from CPU1 to the other cores.
+ */
+
+#ifndef MEASUREMENT_RING_H_
+#define MEASUREMENT_RING_H_
+
+#include <Ifx_Types.h>
+
+/*********************************************************************************************************************/
+/*------------------------------------------------------Macros-------------------------------------------------------*/
+/*********************************************************************************************************************/
+#define MEASUREMENT_RING_LENGTH     16      // Number of records kept for the consumers, older ones are overwritten
+
+/*********************************************************************************************************************/
+/*---------------------------------------------Type Definitions------------------------------------------------------*/
+/*********************************************************************************************************************/
+/**
+ * @brief Measurement record.
+ * @details Values of one calculation.
+ */
+typedef struct
+{
+    uint64 timestamp;       /**< STM ticks of the calculation. */
+    uint32 sequence;        /**< Number of the record, counted up from 0. */
+    sint32 heart_rate;      /**< Heart rate value. */
+    uint8 spo2;             /**< SpO2 value. */
+    uint8 quality;          /**< Quality of the values, the confidence of the calculation. */
+
+} measurement_t;
+
+/**
+ * @brief Measurement consumer cursor.
+ * @details Read position of one consumer, kept by the consumer itself. A
+ * zeroed cursor starts with the first record.
+ */
+typedef struct
+{
+    uint32 next_sequence;   /**< Sequence number of the next record to read. */
+    uint32 missed;          /**< Number of records which were overwritten before they were read. */
+
+} measurement_cursor_t;
+
+/*********************************************************************************************************************/
+/*---------------------------------------------Function Definitions----------------------------------------------*/
+/*********************************************************************************************************************/
+/**
+ * @brief Measurement publish function.
+ * @details This function stores a record in the next slot of the ring and
+ * sets its sequence number. The oldest record is overwritten, the producer
+ * never waits for the consumers.
+ * @param[in,out] measurement : Record to publish, the sequence number is set.
+ * @return Nothing.
+ * @note Only one producer is allowed, the records are written by CPU1.
+ */
+void measurement_ring_publish(measurement_t *measurement);
+
+/**
+ * @brief Measurement read function.
+ * @details This function copies the next unread record of the consumer and
+ * advances its cursor. If the producer overwrote records the consumer did not
+ * read yet, the cursor skips to the oldest record still in the ring and the
+ * skipped records are added to the missed count.
+ * @param[in,out] cursor : Cursor of the consumer.
+ * @param[out] measurement : Copy of the record.
+ * @return @li @c TRUE - A record was read,
+ *         @li @c FALSE - No new record.
+ * @note Every core keeps its own cursor, consumers never block each other.
+ */
+boolean measurement_ring_read(measurement_cursor_t *cursor, measurement_t *measurement);
+
+#endif /* MEASUREMENT_RING_H_ */
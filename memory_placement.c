@@ -0,0 +1,33 @@
+/*
+ * memory_placement.c
+ *
+ *  Created on: 17.10.2026
+ *      Author: Andreas Reichenauer
+ */
+
+/*!
+ * @file memory_placement.c
+ * @brief This file implements the placement check of the objects placed by memory_placement.h.
+ */
+
+#include <memory_placement.h>
+
+#if MEMORY_PLACEMENT_CHECK
+/*************************************************************************************************************/
+/*-------------------------------------------------Global variables------------------------------------------*/
+/*************************************************************************************************************/
+uint32 memory_placement_errors = 0;
+const char *memory_placement_misplaced = NULL_PTR;
+
+/*************************************************************************************************************/
+/*---------------------------------------------Function Implementations--------------------------------------*/
+/*************************************************************************************************************/
+void memory_placement_check(const volatile void *object, uint32 memory, const char *name){
+    // every scratchpad and the LMU lie in their own 1M segment
+    if(((uint32)object & 0xFFF00000) == memory)
+        return;
+
+    memory_placement_errors++;
+    memory_placement_misplaced = name;
+}
+#endif
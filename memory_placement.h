@@ -0,0 +1,109 @@
+/*
+ * memory_placement.h
+ *
+ *  Created on: 17.10.2026
+ *      Author: Andreas Reichenauer
+ */
+
+/*!
+ * @file memory_placement.h
+ * @brief This file contains the macros placing variables in the memory of the core which uses them.
+ */
+
+#ifndef MEMORY_PLACEMENT_H_
+#define MEMORY_PLACEMENT_H_
+
+#include <Ifx_Types.h>
+
+/*********************************************************************************************************************/
+/*------------------------------------------------------Macros-------------------------------------------------------*/
+/*********************************************************************************************************************/
+/*
+ * Variables without a placement end up in default_ram, the scratchpad (DSPR) of CPU1. The other cores reach it only
+ * over the crossbar, so variables used by one core are placed in its own DSPR and variables shared by the cores in
+ * the LMU. The section names are the ones selected by Lcf_Gnuc_Tricore_Tc.lsl and Lcf_Tasking_Tricore_Tc.lsl.
+ * The BSS macros are for variables without an initial value or initialized to 0, they are cleared at startup.
+ */
+#if defined(__TASKING__)
+#define PLACE_IN_SECTION(gnuc_name, tasking_name)   __attribute__ ((section(tasking_name)))
+#else
+#define PLACE_IN_SECTION(gnuc_name, tasking_name)   __attribute__ ((section(gnuc_name)))
+#endif
+
+#define CPU0_BSS        PLACE_IN_SECTION(".bss_cpu0", ".bss.bss_cpu0")      // Used only by CPU0 (display)
+#define CPU1_BSS        PLACE_IN_SECTION(".bss_cpu1", ".bss.bss_cpu1")      // Used only by CPU1 (sensor), and its DMA
+#define CPU2_BSS        PLACE_IN_SECTION(".bss_cpu2", ".bss.bss_cpu2")      // Used only by CPU2 (UART)
+#define CPU0_DATA       PLACE_IN_SECTION(".data_cpu0", ".data.data_cpu0")   // Initialized, used only by CPU0
+#define LMU_BSS         PLACE_IN_SECTION(".lmubss", ".bss.lmubss")          // Shared by the cores
+
+/*
+ * Functions are executed from flash (pfls0) with wait states. Functions tagged with these macros are copied to the
+ * program scratchpad (PSPR) of the core at startup by the copy table and executed from there without wait states.
+ * Other cores reach a PSPR only slowly over the crossbar, so tag only functions executed by the owning core.
+ */
+#define CPU0_PSPR_CODE  PLACE_IN_SECTION(".cpu0_psram", ".text.cpu0_psram") // Executed only by CPU0
+#define CPU1_PSPR_CODE  PLACE_IN_SECTION(".cpu1_psram", ".text.cpu1_psram") // Executed only by CPU1
+#define CPU2_PSPR_CODE  PLACE_IN_SECTION(".cpu2_psram", ".text.cpu2_psram") // Executed only by CPU2
+
+/*
+ * The heart rate and SpO2 calculation functions are tagged with HR_AND_SPO2_DSP_CODE and copied to the PSPR of the
+ * core executing them. It is CPU1, or CPU2 if the pipeline of hr_and_spo2_pipeline.h hands the windows to CPU2.
+ * hr_and_spo2_flash_copy.c defines HR_AND_SPO2_DSP_FLASH_COPY to build a second copy which stays in flash.
+ */
+#define HR_AND_SPO2_DSP_CPU         1       // Core executing the calculation, 2 only with HR_AND_SPO2_PIPELINE
+#define HR_AND_SPO2_DSP_IN_PSPR     1       // Set to 0 to execute the calculation from flash
+
+#if !HR_AND_SPO2_DSP_IN_PSPR || defined(HR_AND_SPO2_DSP_FLASH_COPY)
+#define HR_AND_SPO2_DSP_CODE
+#elif HR_AND_SPO2_DSP_CPU == 2
+#define HR_AND_SPO2_DSP_CODE        CPU2_PSPR_CODE
+#else
+#define HR_AND_SPO2_DSP_CODE        CPU1_PSPR_CODE
+#endif
+
+/*
+ * lmuram and lmuram_nc are the same 32K of LMU, once through the cached and once through the non-cached segment.
+ * Shared variables are linked to lmuram and accessed through this non-cached alias, because the data caches of
+ * CPU1 and CPU2 are not coherent.
+ */
+#define LMU_NON_CACHED(addr)        ((uint32)(addr) | 0x20000000)
+
+/*
+ * Placement check of single objects, done once by the init function of the module. The memory is told by the upper
+ * 12 bits of the global address. A misplaced object is counted and its name kept in memory_placement_misplaced, read
+ * them with the debugger. The sections themselves are checked at link time by the ASSERTs of Lcf_Gnuc_Tricore_Tc.lsl.
+ */
+#define MEMORY_PLACEMENT_CHECK          1       // Set to 0 to remove the checks from the build
+
+#define MEMORY_CPU0_DSPR                0x70000000
+#define MEMORY_CPU1_DSPR                0x60000000
+#define MEMORY_CPU2_DSPR                0x50000000
+#define MEMORY_LMU                      0x90000000
+#define MEMORY_CPU_DSPR(core)           (MEMORY_CPU0_DSPR - (uint32)(core) * 0x10000000)
+
+#if MEMORY_PLACEMENT_CHECK
+#define PLACEMENT_CHECK(object, memory) memory_placement_check((const volatile void*)&(object), (memory), #object)
+#else
+#define PLACEMENT_CHECK(object, memory)
+#endif
+
+/*********************************************************************************************************************/
+/*------------------------------------------------Global variables---------------------------------------------------*/
+/*********************************************************************************************************************/
+#if MEMORY_PLACEMENT_CHECK
+extern uint32 memory_placement_errors;              // Number of misplaced objects
+extern const char *memory_placement_misplaced;      // Name of the last misplaced object
+#endif
+
+/*********************************************************************************************************************/
+/*---------------------------------------------Function Definitions--------------------------------------------------*/
+/*********************************************************************************************************************/
+#if MEMORY_PLACEMENT_CHECK
+/***
+ * @brief: checks that an object lies in the expected memory, use PLACEMENT_CHECK
+ * @params: object: address of the object, memory: MEMORY_ value of the expected memory, name: name of the object
+ */
+void memory_placement_check(const volatile void *object, uint32 memory, const char *name);
+#endif
+
+#endif /* MEMORY_PLACEMENT_H_ */
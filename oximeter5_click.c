@@ -36,73 +36,93 @@
  */
 
 #include "oximeter5_click.h"
-#include <Bsp.h>                      //Board support functions (for the waitTime function)
+#include <Bsp.h>                      //Board support functions (for the deadline functions)
+#include "memory_placement.h"
 
 #define I2C_FREQ                    400000      // Clock frequency of I2C in Hz
-#define MA4_SIZE                    4
 #define DATA_18_BIT                 0x03FFFF
 #define MAX_UNSIGNED_8_BIT_DATA     0x7F
 #define DATA_CONV_SIGN_8_BIT_DATA   256
 #define BYTE_LOW_NIBBLE             0x0F
 #define TEMPERATURE_DATA_CALC_DATA  0.0625
-#define OXIMETER5_N_X_DC_MAX        -16777216
 #define TX_BUFFER_SIZE              257
+#define I2C_TIMEOUT_MS              10          // Max time for one I2C transfer including NAK retries
+#define TEMP_TIMEOUT_MS             100         // Max time for one temperature conversion
+#define RESET_TIMEOUT_MS            100         // Max time for the software reset
 
-const uint8 uch_spo2_table[ 184 ] =
-{
-    95, 95, 95, 96, 96, 96, 97, 97, 97, 97, 97, 98, 98, 98, 98, 98, 99, 99, 99, 99,
-    99, 99, 99, 99, 100, 100, 100, 100, 100, 100, 100, 100, 100, 100, 100, 100, 100,
-    100, 100, 100, 100, 100, 100, 100, 99, 99, 99, 99, 99, 99, 99, 99, 98, 98, 98,
-    98, 98, 98, 97, 97, 97, 97, 96, 96, 96, 96, 95, 95, 95, 94, 94, 94, 93, 93, 93,
-    92, 92, 92, 91, 91, 90, 90, 89, 89, 89, 88, 88, 87, 87, 86, 86, 85, 85, 84, 84,
-    83, 82, 82, 81, 81, 80, 80, 79, 78, 78, 77, 76, 76, 75, 74, 74, 73, 72, 72, 71,
-    70, 69, 69, 68, 67, 66, 66, 65, 64, 63, 62, 62, 61, 60, 59, 58, 57, 56, 56, 55,
-    54, 53, 52, 51, 50, 49, 48, 47, 46, 45, 44, 43, 42, 41, 40, 39, 38, 37, 36, 35,
-    34, 33, 31, 30, 29, 28, 27, 26, 25, 23, 22, 21, 20, 19, 17, 16, 15, 14, 12, 11,
-    10, 9, 7, 6, 5, 3, 2, 1
-};
+#if OXIMETER5_I2C_TRACE
+// blocking I2C transfers, read it with the debugger
+oximeter5_i2c_trace_t oximeter5_i2c_trace = { 0 };
+#endif
+
+// receive buffer for a blocking burst read of the whole FIFO
+static uint8 fifo_rx_buf[ OXIMETER5_FIFO_RAW_SIZE ] CPU1_BSS;
+
+
+/**
+ * @brief Oximeter 5 combined I2C write and read function.
+ * @details This function sends the register address and reads the data
+ * bytes in one transfer, separated by a repeated start condition.
+ */
+static IfxI2c_I2c_Status dev_i2c_write_read ( IfxI2c_I2c_Device *i2c_dev, uint8 reg, uint8 *rx_buf, uint8 rx_len, Ifx_TickTime deadline );
+
+/**
+ * @brief Oximeter 5 I2C receive function.
+ * @details This function collects the received bytes from the I2C FIFO
+ * until the packet is complete.
+ */
+static IfxI2c_I2c_Status dev_i2c_receive ( Ifx_I2C *i2c, uint8 *rx_buf, uint8 rx_len, Ifx_TickTime deadline );
+
+#if OXIMETER5_I2C_TRACE
+/**
+ * @brief Oximeter 5 I2C trace function.
+ * @details This function records one blocking transfer in #oximeter5_i2c_trace.
+ */
+static void dev_i2c_trace ( uint8 reg, uint8 len, boolean write, uint8 attempts, IfxI2c_I2c_Status status, Ifx_TickTime start );
+#endif
 
 /**
- * @brief Oximeter 5 find peaks above n_min_height function.
- * @details This function find all peaks above MIN_HEIGHT.
+ * @brief Oximeter 5 I2C wait for transmission end function.
+ * @details This function waits until the current packet is transferred or the deadline is over.
  */
-static void dev_peaks_above_min_height ( sint32 *pn_locs, sint32 *n_npks,  sint32  *pn_x, uint8 n_size, sint32 n_min_height );
+static boolean dev_i2c_wait_tx_end ( Ifx_I2C *i2c, Ifx_TickTime deadline );
 
 /**
- * @brief Oximeter 5 sort indices function.
- * @details This function sort indices according to descending order ( insertion sort algorithm ).
+ * @brief Oximeter 5 I2C clear FIFO requests function.
+ * @details This function clears all pending single and burst request flags.
  */
-static void dev_sort_indices_descend ( sint32 *pn_x, sint32 *pn_indx, sint32 n_size );
+static void dev_i2c_clear_requests ( Ifx_I2C *i2c );
 
 /**
- * @brief Oximeter 5 sort array function.
- * @details This function array in ascending order ( insertion sort algorithm ).
+ * @brief Oximeter 5 submit job function.
+ * @details This function fills the I2C job of the context object and submits it.
  */
-static void dev_sort_ascend ( sint32  *pn_x, sint32 n_size );
+static oximeter5_return_value_t dev_submit_job ( oximeter5_t *ctx, i2c_job_type_t type, uint8 reg, uint8 *buf, uint8 len, i2c_job_callback_t job_callback );
 
 /**
- * @brief Oximeter 5 remove peaks function.
- * @details This function remove peaks separated by less than MIN_DISTANCE.
+ * @brief Oximeter 5 finish non-blocking operation function.
+ * @details This function ends the active operation and calls its callback.
  */
-static void dev_remove_close_peaks ( sint32 *pn_locs, sint32 *pn_npks, sint32 *pn_x, sint32 n_min_distance );
+static void dev_async_finish ( oximeter5_t *ctx, oximeter5_return_value_t error_flag );
 
 /**
- * @brief Oximeter 5 find peaks function.
- * @details This function find at most MAX_NUM peaks above MIN_HEIGHT separated by at least MIN_DISTANCE.
+ * @brief Oximeter 5 generic job done function.
+ * @details This function is the job callback of the generic read operation.
  */
-static void dev_find_peaks ( sint32 *pn_locs, sint32 *n_npks,  sint32  *pn_x, uint8 n_size, sint32 n_min_height, sint32 n_min_distance, sint32 n_max_num );
+static void dev_generic_job_done ( i2c_job_t *job );
 
 /**
- * @brief Delay execution for 10ms function.
- * @details This function delays the execution of the program for 10ms.
+ * @brief Oximeter 5 FIFO pointers read function.
+ * @details This function is the job callback of the FIFO pointer read of a burst. It starts the data read of all pending samples.
  */
-static void Delay_10ms ( void );
+static void dev_burst_ptr_done ( i2c_job_t *job );
 
 /**
- * @brief Delay execution for 1s function.
- * @details This function delays the execution of the program for 1s.
+ * @brief Oximeter 5 FIFO data read function.
+ * @details This function is the job callback of the FIFO data read of a burst. It finishes the burst.
  */
-static void Delay_1sec ( void );
+static void dev_burst_data_done ( i2c_job_t *job );
+
 
 void oximeter5_init ( oximeter5_t *ctx )
 {
@@ -140,60 +160,59 @@ void oximeter5_init ( oximeter5_t *ctx )
 
 oximeter5_return_value_t oximeter5_default_cfg ( oximeter5_t *ctx )
 {
-    uint8 tmp;
-
-    oximeter5_return_value_t error_flag = oximeter5_sw_reset( ctx );
-    Delay_1sec( );
-
-    error_flag |= oximeter5_generic_read( ctx, OXIMETER5_REG_INTR_STATUS_1, &tmp, 1 );
-    Delay_10ms( );
-
-    tmp = OXIMETER5_SET_INTR_EN_1_FULL_EN;
-    tmp |= OXIMETER5_SET_INTR_EN_1_PPG_RDY_EN;
-    error_flag |= oximeter5_generic_write( ctx, OXIMETER5_REG_INTR_ENABLE_1, &tmp, 1 );
-    Delay_10ms( );
+    uint8 tmp = 0;
+    uint8 cfg_intr_fifo[ 5 ];
+    uint8 cfg_led[ 2 ];
+    uint8 cfg_mode[ 3 ];
 
-    tmp = OXIMETER5_SET_INTR_EN_2_TEMP_DIS;
-    error_flag |= oximeter5_generic_write( ctx, OXIMETER5_REG_INTR_ENABLE_2, &tmp, 1 );
-    Delay_10ms( );
-
-    tmp = OXIMETER5_SET_FIFO_PTR_RESET;
-    error_flag |= oximeter5_generic_write( ctx, OXIMETER5_REG_FIFO_WR_PTR, &tmp, 1 );
-    Delay_10ms( );
-
-    tmp = OXIMETER5_SET_FIFO_COUNTER_RESET;
-    error_flag |= oximeter5_generic_write( ctx, OXIMETER5_REG_OVF_COUNTER, &tmp, 1 );
-    Delay_10ms( );
-
-    tmp = OXIMETER5_SET_FIFO_PTR_RESET;
-    error_flag |= oximeter5_generic_write( ctx, OXIMETER5_REG_FIFO_RD_PTR, &tmp, 1 );
-    Delay_10ms( );
+    if ( oximeter5_sw_reset( ctx ) == OXIMETER5_ERROR )
+    {
+        return OXIMETER5_ERROR;
+    }
 
-    tmp = OXIMETER5_SET_FIFO_CFG_SMP_AVE_3;
-    tmp |= OXIMETER5_SET_FIFO_CFG_DATA_SAMP_15;
-    error_flag |= oximeter5_generic_write( ctx, OXIMETER5_REG_FIFO_CONFIG, &tmp, 1 );
-    Delay_10ms( );
+    // RESET is cleared by the sensor when the reset is complete
+    Ifx_TickTime deadline = getDeadLine( IfxStm_getTicksFromMilliseconds( BSP_DEFAULT_TIMER, RESET_TIMEOUT_MS ) );
+    do
+    {
+        if ( oximeter5_generic_read( ctx, OXIMETER5_REG_MODE_CONFIG, &tmp, 1 ) == OXIMETER5_ERROR )
+        {
+            return OXIMETER5_ERROR;
+        }
+    }
+    while ( ( tmp & OXIMETER5_SW_RESET ) && !isDeadLine( deadline ) );
 
-    tmp = OXIMETER5_SET_CFG_MODE_SpO2;
-    error_flag |= oximeter5_generic_write( ctx, OXIMETER5_REG_MODE_CONFIG, &tmp, 1 );
-    Delay_10ms( );
+    if ( tmp & OXIMETER5_SW_RESET )
+    {
+        return OXIMETER5_ERROR;
+    }
 
-    tmp = OXIMETER5_SET_SPO2_CFG_ADC_RGE_4096;
-    tmp |= OXIMETER5_SET_SPO2_CFG_SR_SEC_100;
-    tmp |= OXIMETER5_SET_SPO2_CFG_LED_PW_18_bit;
-    error_flag |= oximeter5_generic_write( ctx, OXIMETER5_REG_SPO2_CONFIG, &tmp, 1 );
-    Delay_10ms( );
+    oximeter5_return_value_t error_flag = OXIMETER5_OK;
 
-    tmp = OXIMETER5_SET_LED_PULSE_AMPL_7_2_mA;
-    error_flag |= oximeter5_generic_write( ctx, OXIMETER5_REG_LED1_PA, &tmp, 1 );
-    Delay_10ms( );
+    // clear the power ready interrupt
+    error_flag |= oximeter5_generic_read( ctx, OXIMETER5_REG_INTR_STATUS_1, &tmp, 1 );
 
-    tmp = OXIMETER5_SET_LED_PULSE_AMPL_7_2_mA;
-    error_flag |= oximeter5_generic_write( ctx, OXIMETER5_REG_LED2_PA, &tmp, 1 );
-    Delay_10ms( );
+    // interrupt enables and FIFO pointers, registers 0x02 - 0x06
+    cfg_intr_fifo[ 0 ] = OXIMETER5_SET_INTR_EN_1_FULL_EN | OXIMETER5_SET_INTR_EN_1_PPG_RDY_EN;
+    cfg_intr_fifo[ 1 ] = OXIMETER5_SET_INTR_EN_2_TEMP_DIS;
+    cfg_intr_fifo[ 2 ] = OXIMETER5_SET_FIFO_PTR_RESET;
+    cfg_intr_fifo[ 3 ] = OXIMETER5_SET_FIFO_COUNTER_RESET;
+    cfg_intr_fifo[ 4 ] = OXIMETER5_SET_FIFO_PTR_RESET;
+    error_flag |= oximeter5_generic_write( ctx, OXIMETER5_REG_INTR_ENABLE_1, cfg_intr_fifo, 5 );
+
+    // LED pulse amplitudes, registers 0x0C - 0x0D, set before the mode starts the measurement
+    cfg_led[ 0 ] = OXIMETER5_SET_LED_PULSE_AMPL_7_2_mA;
+    cfg_led[ 1 ] = OXIMETER5_SET_LED_PULSE_AMPL_7_2_mA;
+    error_flag |= oximeter5_generic_write( ctx, OXIMETER5_REG_LED1_PA, cfg_led, 2 );
+
+    // the register pointer does not advance past FIFO_DATA ( 0x07 ), so registers 0x08 - 0x0A are another burst,
+    // it ends before the reserved register 0x0B
+    cfg_mode[ 0 ] = OXIMETER5_SET_FIFO_CFG_SMP_AVE_3 | OXIMETER5_SET_FIFO_CFG_DATA_SAMP_15;
+    cfg_mode[ 1 ] = OXIMETER5_SET_CFG_MODE_SpO2;
+    cfg_mode[ 2 ] = OXIMETER5_SET_SPO2_CFG_ADC_RGE_4096 | OXIMETER5_SET_SPO2_CFG_SR_SEC_100 | OXIMETER5_SET_SPO2_CFG_LED_PW_18_bit;
+    error_flag |= oximeter5_generic_write( ctx, OXIMETER5_REG_FIFO_CONFIG, cfg_mode, 3 );
 
     uint32 ir, red;
-    error_flag = oximeter5_read_sensor_data( ctx, &ir, &red );
+    error_flag |= oximeter5_read_sensor_data( ctx, &ir, &red );
 
     return error_flag;
 }
@@ -210,27 +229,38 @@ oximeter5_return_value_t oximeter5_generic_write ( oximeter5_t *ctx, uint8 reg,
     for (uint8 cnt = 1; cnt <= tx_len; cnt++)
         data_buf[cnt] = tx_buf[cnt - 1];
 
-    // Write TX buffer to device as soon as it is ready
+    // Write TX buffer to device as soon as it is ready, but give up after the timeout
+    Ifx_TickTime start = now();
+    Ifx_TickTime deadline = start + IfxStm_getTicksFromMilliseconds(BSP_DEFAULT_TIMER, I2C_TIMEOUT_MS);
     IfxI2c_I2c_Status i2c_status = IfxI2c_I2c_Status_nak;
-    while(i2c_status == IfxI2c_I2c_Status_nak)
+    uint8 attempts = 0;
+    while(i2c_status == IfxI2c_I2c_Status_nak && !isDeadLine(deadline)){
         i2c_status = IfxI2c_I2c_write(&ctx->i2cDev, data_buf, tx_len+1);
+        attempts++;
+    }
+
+#if OXIMETER5_I2C_TRACE
+    dev_i2c_trace(reg, tx_len, TRUE, attempts, i2c_status, start);
+#endif
 
     return (i2c_status == IfxI2c_I2c_Status_ok) ? OXIMETER5_OK : OXIMETER5_ERROR;
 }
 
 oximeter5_return_value_t oximeter5_generic_read ( oximeter5_t *ctx, uint8 reg, uint8 *rx_buf, uint8 rx_len )
 {
-    // send register to read from
-    if (oximeter5_generic_write(ctx, reg, NULL_PTR, 0) == OXIMETER5_ERROR)
-        return OXIMETER5_ERROR;
-
-    // Wait after register was sent before read is started
-    Delay_10ms( );
-
-    // Read device data to data array
+    // Send register and read device data in one transfer as soon as the device is ready, but give up after the timeout
+    Ifx_TickTime start = now();
+    Ifx_TickTime deadline = start + IfxStm_getTicksFromMilliseconds(BSP_DEFAULT_TIMER, I2C_TIMEOUT_MS);
     IfxI2c_I2c_Status i2c_status = IfxI2c_I2c_Status_nak;
-    while(i2c_status == IfxI2c_I2c_Status_nak)
-        i2c_status = IfxI2c_I2c_read(&ctx->i2cDev, rx_buf, rx_len);
+    uint8 attempts = 0;
+    while(i2c_status == IfxI2c_I2c_Status_nak && !isDeadLine(deadline)){
+        i2c_status = dev_i2c_write_read(&ctx->i2cDev, reg, rx_buf, rx_len, deadline);
+        attempts++;
+    }
+
+#if OXIMETER5_I2C_TRACE
+    dev_i2c_trace(reg, rx_len, FALSE, attempts, i2c_status, start);
+#endif
 
     return (i2c_status == IfxI2c_I2c_Status_ok) ? OXIMETER5_OK : OXIMETER5_ERROR;
 }
@@ -257,7 +287,19 @@ oximeter5_return_value_t oximeter5_read_temperature ( oximeter5_t *ctx, float *t
 
     tx_data = OXIMETER5_SET_CFG_TEMP_ENABLE;
     oximeter5_return_value_t error_flag = oximeter5_generic_write( ctx, OXIMETER5_REG_TEMP_CONFIG, &tx_data, 1 );
-    Delay_10ms( );
+
+    // TEMP_EN is cleared by the sensor when the conversion is complete
+    Ifx_TickTime deadline = getDeadLine( IfxStm_getTicksFromMilliseconds( BSP_DEFAULT_TIMER, TEMP_TIMEOUT_MS ) );
+    do
+    {
+        error_flag |= oximeter5_generic_read( ctx, OXIMETER5_REG_TEMP_CONFIG, &rx_data, 1 );
+    }
+    while ( ( error_flag == OXIMETER5_OK ) && ( rx_data & OXIMETER5_SET_CFG_TEMP_ENABLE ) && !isDeadLine( deadline ) );
+
+    if ( rx_data & OXIMETER5_SET_CFG_TEMP_ENABLE )
+    {
+        error_flag = OXIMETER5_ERROR;
+    }
 
     error_flag |= oximeter5_generic_read( ctx, OXIMETER5_REG_TEMP_INTR, &rx_data, 1 );
 
@@ -316,390 +358,370 @@ oximeter5_return_value_t oximeter5_set_spo2_cfg ( oximeter5_t *ctx, uint8 spo2_a
 
 oximeter5_return_value_t oximeter5_read_sensor_data ( oximeter5_t *ctx, uint32 *ir, uint32 *red )
 {
-    uint8 rx_buf[ 6 ];
+    uint8 rx_buf[ OXIMETER5_FIFO_SAMPLE_SIZE ];
 
-    oximeter5_return_value_t error_flag = oximeter5_generic_read( ctx, OXIMETER5_REG_FIFO_DATA, rx_buf, 6 );
+    oximeter5_return_value_t error_flag = oximeter5_generic_read( ctx, OXIMETER5_REG_FIFO_DATA, rx_buf, OXIMETER5_FIFO_SAMPLE_SIZE );
 
-    *ir = rx_buf[ 0 ];
-    *ir <<= 8;
-    *ir |= rx_buf[ 1 ];
-    *ir <<= 8;
-    *ir |= rx_buf[ 2 ];
-    *ir &= DATA_18_BIT;
-
-    *red = rx_buf[ 3 ];
-    *red <<= 8;
-    *red |= rx_buf[ 4 ];
-    *red <<= 8;
-    *red |= rx_buf[ 5 ];
-    *red &= DATA_18_BIT;
+    oximeter5_unpack_sample( rx_buf, ir, red );
 
     return error_flag;
 }
 
-oximeter5_return_value_t oximeter5_get_oxygen_saturation ( uint32 *pun_ir_buffer, sint32 n_ir_buffer_length, uint32 *pun_red_buffer, uint8 *pn_spo2 )
+oximeter5_return_value_t oximeter5_read_fifo_burst ( oximeter5_t *ctx, uint32 *ir, uint32 *red, uint8 max_samples, uint8 *n_samples, uint8 *n_overflow )
 {
-    uint32 un_ir_mean;
-    sint32 n_i_ratio_count;
-    sint32 n_exact_ir_valley_locs_count, n_middle_idx;
-    sint32 n_th1, n_npks;
-    sint32 an_ir_valley_locs[ 15 ];
-    sint32 n_y_ac, n_x_ac;
-    sint32 n_spo2_calc;
-    sint32 n_y_dc_max, n_x_dc_max;
-    sint32 n_y_dc_max_idx, n_x_dc_max_idx;
-    sint32 an_ratio[ 5 ], n_ratio_average;
-    sint32 n_nume, n_denom ;
-    sint32 an_x[ BUFFER_SIZE ];
-    sint32 an_y[ BUFFER_SIZE ];
-    oximeter5_return_value_t error_flag;
+    uint8 fifo_ptr[ 3 ];
+    uint8 n_pending;
 
-    un_ir_mean = 0;
+    *n_samples = 0;
+    *n_overflow = 0;
 
-    for ( sint32 n_cnt_k = 0; n_cnt_k < n_ir_buffer_length; n_cnt_k++ )
+    // FIFO_WR_PTR, OVF_COUNTER and FIFO_RD_PTR are consecutive registers and are read at once
+    if ( oximeter5_generic_read( ctx, OXIMETER5_REG_FIFO_WR_PTR, fifo_ptr, 3 ) == OXIMETER5_ERROR )
     {
-        un_ir_mean += pun_ir_buffer[ n_cnt_k ];
+        return OXIMETER5_ERROR;
     }
 
-    un_ir_mean =un_ir_mean/n_ir_buffer_length ;
+    *n_overflow = fifo_ptr[ 1 ] & OXIMETER5_FIFO_PTR_MASK;
 
-    // remove DC and invert signal so that we can use peak detector as valley detector
-    for ( sint32 n_cnt_k = 0; n_cnt_k < n_ir_buffer_length; n_cnt_k++ )
+    // equal pointers mean an empty FIFO, or a full one if samples were already lost
+    n_pending = ( fifo_ptr[ 0 ] - fifo_ptr[ 2 ] ) & OXIMETER5_FIFO_PTR_MASK;
+    if ( ( n_pending == 0 ) && ( *n_overflow != 0 ) )
     {
-        an_x[ n_cnt_k ] = -1*(pun_ir_buffer[ n_cnt_k ] - un_ir_mean );
+        n_pending = OXIMETER5_FIFO_DEPTH;
     }
 
-    // 4 pt Moving Average
-    for ( sint32 n_cnt_k = 0; n_cnt_k < BUFFER_SIZE-MA4_SIZE; n_cnt_k++ )
+    if ( n_pending > max_samples )
     {
-        an_x[ n_cnt_k ] = ( an_x[ n_cnt_k ] + an_x[ n_cnt_k + 1 ] + an_x[ n_cnt_k + 2 ] + an_x[ n_cnt_k + 3 ] ) / 4;
+        n_pending = max_samples;
     }
 
-    // calculate threshold
-    n_th1 = 0;
-    for ( sint32 n_cnt_k = 0; n_cnt_k < BUFFER_SIZE; n_cnt_k++ )
+    if ( n_pending == 0 )
     {
-        n_th1 +=  an_x[ n_cnt_k ];
+        return OXIMETER5_OK;
     }
 
-    n_th1=  n_th1 / BUFFER_SIZE;
-    if ( n_th1 < 30 )
+    // FIFO_DATA does not autoincrement, so all pending samples are read in one transaction
+    if ( oximeter5_generic_read( ctx, OXIMETER5_REG_FIFO_DATA, fifo_rx_buf, n_pending * OXIMETER5_FIFO_SAMPLE_SIZE ) == OXIMETER5_ERROR )
     {
-        n_th1 = 30; // min allowed
+        return OXIMETER5_ERROR;
     }
 
-    if ( n_th1 > 60 )
+    for ( uint8 n_cnt = 0; n_cnt < n_pending; n_cnt++ )
     {
-        n_th1 = 60; // max allowed
+        oximeter5_unpack_sample( &fifo_rx_buf[ n_cnt * OXIMETER5_FIFO_SAMPLE_SIZE ], &ir[ n_cnt ], &red[ n_cnt ] );
     }
 
-    for ( sint32 n_cnt_k = 0; n_cnt_k < 15; n_cnt_k++ )
-    {
-        an_ir_valley_locs[ n_cnt_k ] = 0;
-    }
+    *n_samples = n_pending;
 
-    // since we flipped signal, we use peak detector as valley detector
-    dev_find_peaks( an_ir_valley_locs, &n_npks, an_x, BUFFER_SIZE, n_th1, 4, 15 );//peak_height, peak_distance, max_num_peaks
+    return OXIMETER5_OK;
+}
 
-    //  load raw value again for SPO2 calculation : RED(=y) and IR(=X)
-    for ( sint32 n_cnt_k = 0; n_cnt_k < n_ir_buffer_length; n_cnt_k++ )
+oximeter5_return_value_t oximeter5_generic_read_async ( oximeter5_t *ctx, uint8 reg, uint8 *rx_buf, uint8 rx_len, oximeter5_callback_t callback, void *arg )
+{
+    if ( ctx->async.busy )
     {
-        an_x[ n_cnt_k ] = pun_ir_buffer[ n_cnt_k ];
-        an_y[ n_cnt_k ] = pun_red_buffer[ n_cnt_k ];
+        return OXIMETER5_ERROR;
     }
 
-    // find precise min near an_ir_valley_locs
-    n_exact_ir_valley_locs_count = n_npks;
+    ctx->async.busy = TRUE;
+    ctx->async.callback = callback;
+    ctx->async.arg = arg;
 
-    //using exact_ir_valley_locs , find ir-red DC andir-red AC for SPO2 calibration an_ratio
-    //finding AC/DC maximum of raw
-    n_ratio_average = 0;
-    n_i_ratio_count = 0;
+    return dev_submit_job( ctx, I2C_JOB_READ, reg, rx_buf, rx_len, dev_generic_job_done );
+}
 
-    for ( sint32 n_cnt_k = 0; n_cnt_k < 5; n_cnt_k++ )
+oximeter5_return_value_t oximeter5_read_fifo_raw_async ( oximeter5_t *ctx, uint8 *raw_buf, uint8 max_samples, uint8 *n_samples, uint8 *n_overflow, oximeter5_callback_t callback, void *arg )
+{
+    if ( ctx->async.busy )
     {
-        an_ratio[ n_cnt_k ] = 0;
+        return OXIMETER5_ERROR;
     }
 
-    for ( sint32 n_cnt_k = 0; n_cnt_k < n_exact_ir_valley_locs_count; n_cnt_k++ )
-    {
-        if ( an_ir_valley_locs[ n_cnt_k ] > BUFFER_SIZE )
-        {
-            // do not use SPO2 since valley loc is out of range
-            *pn_spo2 = OXIMETER5_PN_SPO2_ERROR_DATA;
-            error_flag  = OXIMETER5_ERROR;
-        }
-    }
+    ctx->async.busy = TRUE;
+    ctx->async.callback = callback;
+    ctx->async.arg = arg;
+    ctx->async.raw = raw_buf;
+    ctx->async.max_samples = max_samples;
+    ctx->async.n_samples = n_samples;
+    ctx->async.n_overflow = n_overflow;
 
-    // find max between two valley locations
-    // and use an_ratio betwen AC compoent of Ir & Red and DC compoent of Ir & Red for SPO2
-    for ( sint32 n_cnt_k = 0; n_cnt_k < n_exact_ir_valley_locs_count - 1; n_cnt_k++ )
-    {
-        n_y_dc_max= OXIMETER5_N_X_DC_MAX;
-        n_x_dc_max= OXIMETER5_N_X_DC_MAX;
+    *n_samples = 0;
+    *n_overflow = 0;
 
-        if ( an_ir_valley_locs[ n_cnt_k + 1 ] - an_ir_valley_locs[ n_cnt_k ] > 3 )
-        {
-            for ( sint32 n_cnt_i = an_ir_valley_locs[ n_cnt_k]; n_cnt_i < an_ir_valley_locs[ n_cnt_k + 1 ]; n_cnt_i++ )
-            {
-                if ( an_x[ n_cnt_i ] > n_x_dc_max )
-                {
-                    n_x_dc_max = an_x[ n_cnt_i ];
-                    n_x_dc_max_idx = n_cnt_i;
-                }
-
-                if ( an_y[ n_cnt_i ] > n_y_dc_max )
-                {
-                    n_y_dc_max = an_y[ n_cnt_i ];
-                    n_y_dc_max_idx = n_cnt_i;
-
-                }
-            }
+    // FIFO_WR_PTR, OVF_COUNTER and FIFO_RD_PTR are consecutive registers and are read at once into one word
+    return dev_submit_job( ctx, I2C_JOB_READ, OXIMETER5_REG_FIFO_WR_PTR, ( uint8* ) &ctx->async.fifo_ptr_word, 3, dev_burst_ptr_done );
+}
 
-            //red
-            n_y_ac = ( an_y[ an_ir_valley_locs[ n_cnt_k + 1 ] ] - an_y[ an_ir_valley_locs[ n_cnt_k ] ] ) * ( n_y_dc_max_idx - an_ir_valley_locs[ n_cnt_k ] );
-            n_y_ac =  an_y[an_ir_valley_locs[ n_cnt_k ] ] + n_y_ac / ( an_ir_valley_locs[ n_cnt_k + 1 ] - an_ir_valley_locs[ n_cnt_k ] );
-            // subracting linear DC compoenents from raw
-            n_y_ac =  an_y[ n_y_dc_max_idx ] - n_y_ac;
-            // ir
-            n_x_ac = ( an_x[ an_ir_valley_locs[ n_cnt_k + 1 ] ] - an_x[ an_ir_valley_locs[ n_cnt_k ] ] ) * ( n_x_dc_max_idx - an_ir_valley_locs[ n_cnt_k ] );
-            // subracting linear DC compoenents from raw
-            n_x_ac =  an_x[ an_ir_valley_locs[ n_cnt_k ] ] + n_x_ac / ( an_ir_valley_locs[ n_cnt_k + 1 ] - an_ir_valley_locs[ n_cnt_k ] );
-            n_x_ac =  an_x[ n_y_dc_max_idx ] - n_x_ac;
-            //prepare X100 to preserve floating value
-            n_nume =( n_y_ac * n_x_dc_max ) >> 7;
-            n_denom = ( n_x_ac * n_y_dc_max ) >> 7;
-
-            if ( ( n_denom > 0 )  && ( n_i_ratio_count < 5 ) && ( n_nume != 0 ) )
-            {
-                an_ratio[ n_i_ratio_count ] = ( n_nume * 100 ) / n_denom;
-                n_i_ratio_count++;
-            }
-        }
+static IfxI2c_I2c_Status dev_i2c_write_read ( IfxI2c_I2c_Device *i2c_dev, uint8 reg, uint8 *rx_buf, uint8 rx_len, Ifx_TickTime deadline )
+{
+    Ifx_I2C *i2c = i2c_dev->i2c->i2c;
+    uint8 sl_addr = i2c_dev->deviceAddress;
+    IfxI2c_I2c_Status status = IfxI2c_I2c_Status_ok;
+
+    if ( IfxI2c_busIsFree( i2c ) == FALSE )
+    {
+        i2c_dev->i2c->busStatus = IfxI2c_getBusStatus( i2c );
+        i2c_dev->i2c->status = IfxI2c_I2c_Status_busNotFree;
+        return IfxI2c_I2c_Status_busNotFree;
     }
 
-    // choose median value since PPG signal may varies from beat to beat
-    dev_sort_ascend( an_ratio, n_i_ratio_count );
-    n_middle_idx = n_i_ratio_count / 2;
+    IfxI2c_clearAllProtocolInterruptSources( i2c );
+    IfxI2c_clearAllErrorInterruptSources( i2c );
+
+    // slave address and register in one packet, the module keeps the bus after the packet ( ADDRCFG.SOPE = 0 )
+    IfxI2c_setTransmitPacketSize( i2c, 2 );
+    IfxI2c_writeFifo( i2c, ( uint32 ) sl_addr | ( ( uint32 ) reg << 8 ) );
+    dev_i2c_clear_requests( i2c );
 
-    if ( n_middle_idx > 1 )
+    if ( dev_i2c_wait_tx_end( i2c, deadline ) == FALSE )
     {
-        // use median
-        n_ratio_average = ( an_ratio[ n_middle_idx - 1 ] + an_ratio[ n_middle_idx ] ) / 2;
+        status = IfxI2c_I2c_Status_error;
     }
-    else
+    else if ( IfxI2c_getProtocolInterruptSourceStatus( i2c, IfxI2c_ProtocolInterruptSource_arbitrationLost ) == TRUE )
     {
-        n_ratio_average = an_ratio[ n_middle_idx ];
+        status = IfxI2c_I2c_Status_al;
     }
-
-    if ( ( n_ratio_average > 2 ) && ( n_ratio_average < 184 ) )
+    else if ( IfxI2c_getProtocolInterruptSourceStatus( i2c, IfxI2c_ProtocolInterruptSource_notAcknowledgeReceived ) == TRUE )
     {
-        n_spo2_calc = uch_spo2_table[ n_ratio_average ];
-        *pn_spo2 = (uint8)n_spo2_calc;
-        error_flag = OXIMETER5_OK;
+        status = IfxI2c_I2c_Status_nak;
     }
     else
     {
-        *pn_spo2 = OXIMETER5_PN_SPO2_ERROR_DATA;
-        error_flag  = OXIMETER5_ERROR;
+        // the next packet starts with a repeated start condition, slave address with RnW bit set
+        IfxI2c_clearAllProtocolInterruptSources( i2c );
+        IfxI2c_setTransmitPacketSize( i2c, 1 );
+        IfxI2c_setReceivePacketSize( i2c, rx_len );
+        IfxI2c_writeFifo( i2c, ( uint32 ) sl_addr | 1 );
+        dev_i2c_clear_requests( i2c );
+
+        status = dev_i2c_receive( i2c, rx_buf, rx_len, deadline );
     }
 
-    return error_flag;
+    IfxI2c_clearAllErrorInterruptSources( i2c );
+    IfxI2c_clearAllProtocolInterruptSources( i2c );
+
+    // stop condition
+    IfxI2c_releaseBus( i2c );
+    i2c_dev->i2c->busStatus = IfxI2c_getBusStatus( i2c );
+    i2c_dev->i2c->status = status;
+
+    return status;
 }
 
-oximeter5_return_value_t oximeter5_get_heart_rate ( uint32 *pun_ir_buffer, sint32 n_ir_buffer_length, uint32 *pun_red_buffer, sint32 *pn_heart_rate )
+static IfxI2c_I2c_Status dev_i2c_receive ( Ifx_I2C *i2c, uint8 *rx_buf, uint8 rx_len, Ifx_TickTime deadline )
 {
-    uint32 un_ir_mean;
-    sint32 n_th1, n_npks;
-    sint32 an_ir_valley_locs[ 15 ];
-    sint32 n_peak_interval_sum;
-    sint32 an_x[ BUFFER_SIZE ];
-     oximeter5_return_value_t error_flag;
+    IfxI2c_I2c_Status status = IfxI2c_I2c_Status_ok;
+    uint32 rx_word;
+    uint8 n_bytes;
 
-    // calculates DC mean and subtract DC from ir
-    un_ir_mean = 0;
-    for ( sint32 n_cnt_k = 0; n_cnt_k < n_ir_buffer_length; n_cnt_k++ )
+    // interrupts stay enabled: with the FIFO flow control of the module ( FIFOCFG.RXFC = 1 ) the clock is stretched
+    // while the RX FIFO is full, so a read longer than the FIFO only takes longer if the loop is interrupted
+    for ( uint8 n_cnt = 0; ( n_cnt < rx_len ) && ( status == IfxI2c_I2c_Status_ok ); n_cnt += n_bytes )
     {
-        un_ir_mean += pun_ir_buffer[ n_cnt_k ];
-    }
+        n_bytes = ( rx_len - n_cnt >= 4 ) ? 4 : rx_len - n_cnt;
 
-    un_ir_mean = un_ir_mean / n_ir_buffer_length;
+        // wait for FIFO request or error
+        uint32 ris;
+        while ( !( ris = i2c->RIS.U ) && !isDeadLine( deadline ) );
 
-    // remove DC and invert signal so that we can use peak detector as valley detector
-    for ( sint32 n_cnt_k = 0; n_cnt_k < n_ir_buffer_length; n_cnt_k++ )
-    {
-        an_x[ n_cnt_k ] = -1 * ( pun_ir_buffer[ n_cnt_k ] - un_ir_mean );
-    }
+        if ( ris & ( 1 << IFX_I2C_RIS_I2C_ERR_INT_OFF ) )
+        {
+            status = IfxI2c_I2c_Status_error;
+        }
+        else if ( IfxI2c_getProtocolInterruptSourceStatus( i2c, IfxI2c_ProtocolInterruptSource_arbitrationLost ) == TRUE )
+        {
+            status = IfxI2c_I2c_Status_al;
+        }
+        else if ( IfxI2c_getProtocolInterruptSourceStatus( i2c, IfxI2c_ProtocolInterruptSource_notAcknowledgeReceived ) == TRUE )
+        {
+            status = IfxI2c_I2c_Status_nak;
+        }
+        else if ( ris & ( ( 1 << IFX_I2C_RIS_LSREQ_INT_OFF ) | ( 1 << IFX_I2C_RIS_SREQ_INT_OFF ) | ( 1 << IFX_I2C_RIS_LBREQ_INT_OFF ) | ( 1 << IFX_I2C_RIS_BREQ_INT_OFF ) ) )
+        {
+            // the FIFO is byte aligned, the first byte is in the lowest byte of the word
+            rx_word = i2c->RXD.U;
+            dev_i2c_clear_requests( i2c );
 
-    // 4 pt Moving Average
-    for( sint32 n_cnt_k = 0; n_cnt_k < BUFFER_SIZE - MA4_SIZE; n_cnt_k++ )
-    {
-        an_x[ n_cnt_k ]=( an_x[ n_cnt_k ] + an_x[ n_cnt_k + 1 ] + an_x[ n_cnt_k + 2 ] + an_x[ n_cnt_k + 3 ] ) / 4;
+            for ( uint8 n_byte = 0; n_byte < n_bytes; n_byte++ )
+            {
+                rx_buf[ n_cnt + n_byte ] = ( uint8 ) ( rx_word >> ( 8 * n_byte ) );
+            }
+        }
+        else
+        {
+            // deadline is over
+            status = IfxI2c_I2c_Status_error;
+        }
     }
 
-    // calculate threshold
-    n_th1 = 0;
-    for ( sint32 n_cnt_k = 0; n_cnt_k < BUFFER_SIZE; n_cnt_k++ )
+    if ( ( status == IfxI2c_I2c_Status_ok ) && ( dev_i2c_wait_tx_end( i2c, deadline ) == FALSE ) )
     {
-        n_th1 +=  an_x[ n_cnt_k ];
+        status = IfxI2c_I2c_Status_error;
     }
 
-    n_th1 = n_th1 / BUFFER_SIZE;
+    return status;
+}
 
-    if ( n_th1 < 30 )
+#if OXIMETER5_I2C_TRACE
+static void dev_i2c_trace ( uint8 reg, uint8 len, boolean write, uint8 attempts, IfxI2c_I2c_Status status, Ifx_TickTime start )
+{
+    oximeter5_i2c_trace_entry_t *entry = &oximeter5_i2c_trace.entry[ oximeter5_i2c_trace.count % OXIMETER5_I2C_TRACE_LENGTH ];
+    uint32 ticks = ( uint32 ) ( now( ) - start );
+
+    entry->reg = reg;
+    entry->len = len;
+    entry->write = write;
+    entry->attempts = attempts;
+    entry->status = status;
+    entry->ticks = ticks;
+
+    oximeter5_i2c_trace.count++;
+    if ( status != IfxI2c_I2c_Status_ok )
     {
-        n_th1 = 30; // min allowed
+        oximeter5_i2c_trace.errors++;
     }
-
-    if( n_th1 > 60 )
+    if ( ticks > oximeter5_i2c_trace.max_ticks )
     {
-        n_th1 = 60; // max allowed
+        oximeter5_i2c_trace.max_ticks = ticks;
     }
+}
+#endif
 
-    for ( sint32 n_cnt_k = 0; n_cnt_k < 15; n_cnt_k++ )
+static boolean dev_i2c_wait_tx_end ( Ifx_I2C *i2c, Ifx_TickTime deadline )
+{
+    while ( IfxI2c_getProtocolInterruptSourceStatus( i2c, IfxI2c_ProtocolInterruptSource_transmissionEnd ) == FALSE )
     {
-        an_ir_valley_locs[ n_cnt_k ] = 0;
+        if ( isDeadLine( deadline ) )
+        {
+            return FALSE;
+        }
     }
 
-    // since we flipped signal, we use peak detector as valley detector
-    dev_find_peaks( an_ir_valley_locs, &n_npks, an_x, BUFFER_SIZE, n_th1, 4, 15 );//peak_height, peak_distance, max_num_peaks
+    IfxI2c_clearProtocolInterruptSource( i2c, IfxI2c_ProtocolInterruptSource_transmissionEnd );
 
-    n_peak_interval_sum = 0;
+    return TRUE;
+}
 
-    if ( n_npks >= 2 )
-    {
-        for ( sint32 n_cnt_k = 1; n_cnt_k < n_npks; n_cnt_k++ )
-        {
-            n_peak_interval_sum += ( an_ir_valley_locs[ n_cnt_k ] -an_ir_valley_locs[ n_cnt_k - 1 ] );
-        }
+static void dev_i2c_clear_requests ( Ifx_I2C *i2c )
+{
+    IfxI2c_clearLastSingleRequestInterruptSource( i2c );
+    IfxI2c_clearSingleRequestInterruptSource( i2c );
+    IfxI2c_clearLastBurstRequestInterruptSource( i2c );
+    IfxI2c_clearBurstRequestInterruptSource( i2c );
+}
 
-        n_peak_interval_sum = n_peak_interval_sum / ( n_npks - 1 );
-        *pn_heart_rate = ( sint32 ) ( ( SAMPLING_FREQUENCY * 60 ) / n_peak_interval_sum );
-        error_flag  = OXIMETER5_OK;
-    }
-    else
+static oximeter5_return_value_t dev_submit_job ( oximeter5_t *ctx, i2c_job_type_t type, uint8 reg, uint8 *buf, uint8 len, i2c_job_callback_t job_callback )
+{
+    i2c_job_t *job = &ctx->async.job;
+
+    job->device = &ctx->i2cDev;
+    job->type = type;
+    job->reg = reg;
+    job->data = buf;
+    job->len = len;
+    job->retries = I2C_JOB_DEFAULT_RETRIES;
+    job->callback = job_callback;
+    job->arg = ctx;
+
+    if ( submit_i2c_job( job ) == FALSE )
     {
-        *pn_heart_rate = OXIMETER5_HEART_RATE_ERROR_DATA; // unable to calculate because # of peaks are too small
-        error_flag  = OXIMETER5_ERROR;
+        ctx->async.busy = FALSE;
+        return OXIMETER5_ERROR;
     }
 
-  return error_flag;
-
+    return OXIMETER5_OK;
 }
 
-static void dev_peaks_above_min_height ( sint32 *pn_locs, sint32 *n_npks,  sint32  *pn_x, uint8 n_size, sint32 n_min_height )
+static void dev_async_finish ( oximeter5_t *ctx, oximeter5_return_value_t error_flag )
 {
-    uint8 n_width;
-    uint8 n_cnt = 1;
-
-    *n_npks = 0;
+    ctx->async.busy = FALSE;
 
-    while ( n_cnt < ( n_size - 1 ) )
+    if ( ctx->async.callback != NULL )
     {
-        if ( pn_x[ n_cnt ] > n_min_height && pn_x[ n_cnt ] > pn_x[ n_cnt - 1 ] )
-        {
-            n_width = 1;
-
-            while ( n_cnt + n_width < n_size && pn_x[ n_cnt ] == pn_x[ n_cnt + n_width ] )
-            {
-                n_width++;
-            }
-
-            if ( pn_x[ n_cnt ] > pn_x[ n_cnt + n_width ] && ( *n_npks ) < 15 )
-            {
-                pn_locs[( *n_npks )++ ] = n_cnt;
-                n_cnt += n_width + 1;
-            }
-            else
-            {
-                n_cnt += n_width;
-            }
-        }
-        else
-        {
-            n_cnt++;
-        }
+        ctx->async.callback( error_flag, ctx->async.arg );
     }
 }
 
+static void dev_generic_job_done ( i2c_job_t *job )
+{
+    dev_async_finish( ( oximeter5_t* ) job->arg, ( job->status == IfxI2c_I2c_Status_ok ) ? OXIMETER5_OK : OXIMETER5_ERROR );
+}
 
-static void dev_sort_indices_descend ( sint32 *pn_x, sint32 *pn_indx, sint32 n_size )
+static void dev_burst_ptr_done ( i2c_job_t *job )
 {
-    sint32 n_temp;
+    oximeter5_t *ctx = ( oximeter5_t* ) job->arg;
+    oximeter5_async_t *async = &ctx->async;
+    uint8 wr_ptr;
+    uint8 rd_ptr;
 
-    for ( sint32 n_cnt_i = 1; n_cnt_i < n_size; n_cnt_i++ )
+    if ( job->status != IfxI2c_I2c_Status_ok )
     {
-        n_temp = pn_indx[ n_cnt_i ];
+        dev_async_finish( ctx, OXIMETER5_ERROR );
+        return;
+    }
 
-        sint32 n_cnt_j;
-        for ( n_cnt_j = n_cnt_i; n_cnt_j > 0 && pn_x[ n_temp ] > pn_x[ pn_indx[ n_cnt_j - 1 ] ]; n_cnt_j-- )
-        {
-            pn_indx[ n_cnt_j ] = pn_indx[ n_cnt_j - 1 ];
-        }
+    // the first register received is the lowest byte of the little endian word
+    wr_ptr = ( uint8 ) ( async->fifo_ptr_word & 0xFF );
+    *async->n_overflow = ( uint8 ) ( async->fifo_ptr_word >> 8 ) & OXIMETER5_FIFO_PTR_MASK;
+    rd_ptr = ( uint8 ) ( async->fifo_ptr_word >> 16 );
 
-        pn_indx[ n_cnt_j ] = n_temp;
+    // equal pointers mean an empty FIFO, or a full one if samples were already lost
+    async->n_pending = ( wr_ptr - rd_ptr ) & OXIMETER5_FIFO_PTR_MASK;
+    if ( ( async->n_pending == 0 ) && ( *async->n_overflow != 0 ) )
+    {
+        async->n_pending = OXIMETER5_FIFO_DEPTH;
     }
-}
-
-static void dev_sort_ascend ( sint32  *pn_x, sint32 n_size )
-{
-    sint32 n_temp;
 
-    for ( sint32 n_cnt_i = 1; n_cnt_i < n_size; n_cnt_i++ )
+    if ( async->n_pending > async->max_samples )
     {
-        n_temp = pn_x[ n_cnt_i ];
+        async->n_pending = async->max_samples;
+    }
 
-        sint32 n_cnt_j;
-        for ( n_cnt_j = n_cnt_i; n_cnt_j > 0 && n_temp < pn_x[ n_cnt_j - 1 ]; n_cnt_j-- )
-        {
-            pn_x[ n_cnt_j ] = pn_x[ n_cnt_j - 1 ];
-        }
+    if ( async->n_pending == 0 )
+    {
+        *async->n_samples = 0;
+        dev_async_finish( ctx, OXIMETER5_OK );
+        return;
+    }
 
-        pn_x[ n_cnt_j ] = n_temp;
+    // FIFO_DATA does not autoincrement, so all pending samples are read in one transaction
+    if ( dev_submit_job( ctx, I2C_JOB_READ, OXIMETER5_REG_FIFO_DATA, async->raw,
+                         async->n_pending * OXIMETER5_FIFO_SAMPLE_SIZE, dev_burst_data_done ) == OXIMETER5_ERROR )
+    {
+        dev_async_finish( ctx, OXIMETER5_ERROR );
     }
 }
 
-static void dev_remove_close_peaks ( sint32 *pn_locs, sint32 *pn_npks, sint32 *pn_x, sint32 n_min_distance )
+static void dev_burst_data_done ( i2c_job_t *job )
 {
-    sint32 n_old_npks, n_dist;
+    oximeter5_t *ctx = ( oximeter5_t* ) job->arg;
 
-    dev_sort_indices_descend( pn_x, pn_locs, *pn_npks );
-
-    for ( sint32 n_cnt_i = -1; n_cnt_i < *pn_npks; n_cnt_i++ )
+    if ( job->status != IfxI2c_I2c_Status_ok )
     {
-        n_old_npks = *pn_npks;
-        *pn_npks = n_cnt_i + 1;
-
-        for ( sint32 n_cnt_j = n_cnt_i + 1; n_cnt_j < n_old_npks; n_cnt_j++ )
-        {
-            n_dist =  pn_locs[ n_cnt_j ] - ( n_cnt_i == -1 ? -1 : pn_locs[ n_cnt_i ] );
-
-            if ( n_dist > n_min_distance || n_dist < -n_min_distance )
-            {
-                pn_locs[ (*pn_npks)++ ] = pn_locs[ n_cnt_j ];
-            }
-        }
+        dev_async_finish( ctx, OXIMETER5_ERROR );
+        return;
     }
 
-    dev_sort_ascend( pn_locs, *pn_npks );
+    // the unpacking is left to the caller
+    *ctx->async.n_samples = ctx->async.n_pending;
+    dev_async_finish( ctx, OXIMETER5_OK );
 }
 
-static void dev_find_peaks ( sint32 *pn_locs, sint32 *n_npks,  sint32  *pn_x, uint8 n_size, sint32 n_min_height, sint32 n_min_distance, sint32 n_max_num )
+void oximeter5_unpack_sample ( uint8 *rx_buf, uint32 *ir, uint32 *red )
 {
-    dev_peaks_above_min_height( pn_locs, n_npks, pn_x, n_size, n_min_height );
-    dev_remove_close_peaks( pn_locs, n_npks, pn_x, n_min_distance );
-    if ( *n_npks > n_max_num )
-    {
-        *n_npks = n_max_num;
-    }
-}
-
-static void Delay_10ms ( void ){
-    waitTime(IfxStm_getTicksFromMilliseconds(BSP_DEFAULT_TIMER, 10));
-}
+    *ir = rx_buf[ 0 ];
+    *ir <<= 8;
+    *ir |= rx_buf[ 1 ];
+    *ir <<= 8;
+    *ir |= rx_buf[ 2 ];
+    *ir &= DATA_18_BIT;
 
-static void Delay_1sec ( void ){
-    waitTime(IfxStm_getTicksFromMilliseconds(BSP_DEFAULT_TIMER, 1000));
+    *red = rx_buf[ 3 ];
+    *red <<= 8;
+    *red |= rx_buf[ 4 ];
+    *red <<= 8;
+    *red |= rx_buf[ 5 ];
+    *red &= DATA_18_BIT;
 }
 
 // ------------------------------------------------------------------------- END
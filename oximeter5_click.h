@@ -42,6 +42,7 @@
 
 #include "Ifx_Types.h"
 #include "IfxPort.h"
+#include "i2c_job_queue.h"
 
 /*!
  * @addtogroup oximeter5 Oximeter 5 Click Driver
@@ -184,6 +185,15 @@
 #define OXIMETER5_INTERRUPT_INACTIVE              0x00
 #define OXIMETER5_INTERRUPT_ACTIVE                0x01
 
+#define OXIMETER5_FIFO_DEPTH                      32
+#define OXIMETER5_FIFO_PTR_MASK                   0x1F
+#define OXIMETER5_FIFO_SAMPLE_SIZE                6
+#define OXIMETER5_FIFO_RAW_SIZE                   ( OXIMETER5_FIFO_DEPTH * OXIMETER5_FIFO_SAMPLE_SIZE )
+
+// set to 1 to record the blocking I2C transfers in oximeter5_i2c_trace, read it with the debugger
+#define OXIMETER5_I2C_TRACE                       0
+#define OXIMETER5_I2C_TRACE_LENGTH                16        // Number of recorded transfers, the oldest is overwritten
+
 /**
  * @brief Oximeter 5 device address setting.
  * @details Specified setting for device slave address selection of
@@ -212,9 +222,60 @@
 #define SAMPLING_FREQUENCY          25
 // max number of samples saved in buffer
 #define BUFFER_SIZE                 ( SAMPLING_FREQUENCY * 4 )
+// number of samples used for the moving average of the IR signal
+#define MA4_SIZE                    4
+// max number of valleys detected in one buffer
+#define OXIMETER5_MAX_VALLEYS       15
+// min distance of two valleys, the shallower one of two closer valleys is dropped
+#define OXIMETER5_MIN_VALLEY_DISTANCE   4
+// limits of the valley detection threshold
+#define OXIMETER5_MIN_THRESHOLD     30
+#define OXIMETER5_MAX_THRESHOLD     60
+// max number of beats whose AC/DC ratio is used for the SpO2 median
+#define OXIMETER5_MAX_RATIOS        5
 
 /*! @} */ // oximeter5_read_set
 
+/**
+ * @brief Oximeter 5 Click return value data.
+ * @details Predefined enum values for driver return values.
+ */
+typedef enum
+{
+    OXIMETER5_OK = 0,
+    OXIMETER5_ERROR = -1
+
+} oximeter5_return_value_t;
+
+/**
+ * @brief Oximeter 5 Click completion callback.
+ * @details Called from the I2C interrupt when a non-blocking operation is
+ * finished, with its result and the argument given to the operation.
+ */
+typedef void ( *oximeter5_callback_t ) ( oximeter5_return_value_t error_flag, void *arg );
+
+/**
+ * @brief Oximeter 5 Click non-blocking operation state.
+ * @details State of the non-blocking operation of a context object, only
+ * one operation can be active at a time.
+ */
+typedef struct
+{
+    i2c_job_t job;                          /**< I2C job of the current transfer. */
+    volatile boolean busy;                  /**< Operation is active. */
+    oximeter5_callback_t callback;          /**< Function called when the operation is finished. */
+    void *arg;                              /**< Argument for the callback. */
+
+    // FIFO burst read
+    uint8 *raw;                             /**< Receive buffer of the FIFO bytes. */
+    uint8 max_samples;                      /**< Max number of samples to read. */
+    uint8 *n_samples;                       /**< Number of samples read output. */
+    uint8 *n_overflow;                      /**< Number of lost samples output. */
+    uint8 n_pending;                        /**< Number of samples to read. */
+    uint32 fifo_ptr_word;                   /**< FIFO_WR_PTR, OVF_COUNTER and FIFO_RD_PTR in bytes 0 to 2, a word for the receive DMA. */
+
+} oximeter5_async_t;
+
 /**
  * @brief Oximeter 5 Click context object.
  * @details Context object definition of Oximeter 5 Click driver.
@@ -229,19 +290,65 @@ typedef struct
     IfxI2c_I2c i2c;                 /**< I2C handle. */
     IfxI2c_I2c_Device i2cDev;       /**< Slave device handle. */
 
+    // Non-blocking operation
+    oximeter5_async_t async;        /**< State of the non-blocking operation. */
+
 } oximeter5_t;
 
+#if OXIMETER5_I2C_TRACE
 /**
- * @brief Oximeter 5 Click return value data.
- * @details Predefined enum values for driver return values.
+ * @brief Oximeter 5 Click I2C trace entry.
+ * @details One blocking transfer of #oximeter5_generic_read or
+ * #oximeter5_generic_write, including the retries while the device does
+ * not acknowledge.
  */
-typedef enum
+typedef struct
 {
-    OXIMETER5_OK = 0,
-    OXIMETER5_ERROR = -1
+    uint8 reg;                      /**< Start register address. */
+    uint8 len;                      /**< Number of data bytes. */
+    boolean write;                  /**< TRUE for a write, FALSE for a read. */
+    uint8 attempts;                 /**< Number of transfers until the device acknowledged or the timeout. */
+    IfxI2c_I2c_Status status;       /**< Result of the last attempt. */
+    uint32 ticks;                   /**< Duration in STM ticks. */
 
-} oximeter5_return_value_t;
+} oximeter5_i2c_trace_entry_t;
 
+/**
+ * @brief Oximeter 5 Click I2C trace.
+ * @details Ring of the last #OXIMETER5_I2C_TRACE_LENGTH blocking transfers.
+ */
+typedef struct
+{
+    oximeter5_i2c_trace_entry_t entry[ OXIMETER5_I2C_TRACE_LENGTH ];    /**< Recorded transfers. */
+    uint32 count;                                                       /**< Number of all transfers, the next entry is count % length. */
+    uint32 errors;                                                      /**< Number of transfers which did not end with ok. */
+    uint32 max_ticks;                                                   /**< Longest transfer in STM ticks. */
+
+} oximeter5_i2c_trace_t;
+
+extern oximeter5_i2c_trace_t oximeter5_i2c_trace;
+#endif
+
+
+/**
+ * @brief Oximeter 5 Click analysis result.
+ * @details Result of one #oximeter5_analyze_window call: both values, the
+ * detected valleys and intermediate data that tells how reliable they are.
+ */
+typedef struct
+{
+    sint32 heart_rate;                                  /**< Heart rate data. */
+    uint8 spo2;                                         /**< SpO2 Oxygen saturation data. */
+    oximeter5_return_value_t heart_rate_error;          /**< Heart rate calculation result. */
+    oximeter5_return_value_t spo2_error;                /**< SpO2 calculation result. */
+    sint32 valley_locs[ OXIMETER5_MAX_VALLEYS ];        /**< Valley locations in the window. */
+    sint32 valley_count;                                /**< Number of detected valleys. */
+    uint32 ir_mean;                                     /**< DC mean of the IR signal. */
+    sint32 threshold;                                   /**< Valley detection threshold. */
+    sint32 ratio_count;                                 /**< Number of beats used for the SpO2 ratio. */
+    sint32 ratio_average;                               /**< Median AC/DC ratio used for the SpO2 lookup. */
+
+} oximeter5_analysis_t;
 
 /*!
  * @addtogroup oximeter5 Oximeter 5 Click Driver
@@ -306,7 +413,9 @@ oximeter5_return_value_t oximeter5_generic_write ( oximeter5_t *ctx, uint8 reg,
  *         @li @c -1 - Error.
  *
  * See #oximeter5_return_value_t definition for detailed explanation.
- * @note None.
+ * @note The register address and the data are transferred with a repeated
+ * start in between. A NAK of the device is retried for at most 10ms. Must
+ * not be used while non-blocking operations are pending.
  */
 oximeter5_return_value_t oximeter5_generic_read ( oximeter5_t *ctx, uint8 reg, uint8 *rx_buf, uint8 rx_len );
 
@@ -467,6 +576,90 @@ oximeter5_return_value_t oximeter5_set_spo2_cfg ( oximeter5_t *ctx, uint8 spo2_a
  */
 oximeter5_return_value_t oximeter5_read_sensor_data ( oximeter5_t *ctx, uint32 *ir, uint32 *red );
 
+/**
+ * @brief Oximeter 5 read FIFO burst function.
+ * @details This function reads the FIFO pointers and the overflow counter
+ * of the MAX30102 High-Sensitivity Pulse Oximeter and
+ * Heart-Rate Sensor for Wearable Health
+ * on the Oximeter 5 Click board and reads all pending samples, up to
+ * @c max_samples, in one I2C transaction.
+ * @param[in] ctx : Click context object.
+ * See #oximeter5_t object definition for detailed explanation.
+ * @param[out] ir : IR ADC data, at least @c max_samples entries.
+ * @param[out] red : Red ADC data, at least @c max_samples entries.
+ * @param[in] max_samples : Max number of samples to read, at most #OXIMETER5_FIFO_DEPTH.
+ * @param[out] n_samples : Number of samples read.
+ * @param[out] n_overflow : Number of samples lost because the FIFO was full.
+ * @return @li @c  0 - Success,
+ *         @li @c -1 - Error.
+ *
+ * See #oximeter5_return_value_t definition for detailed explanation.
+ * @note Samples which are not read stay in the FIFO for the next call.
+ * It blocks for the whole transfer, #oximeter5_read_fifo_raw_async does the
+ * same without blocking.
+ */
+oximeter5_return_value_t oximeter5_read_fifo_burst ( oximeter5_t *ctx, uint32 *ir, uint32 *red, uint8 max_samples, uint8 *n_samples, uint8 *n_overflow );
+
+/**
+ * @brief Oximeter 5 non-blocking I2C reading function.
+ * @details This function submits a read of the given number of data bytes
+ * starting at the selected register and returns at once.
+ * @param[in] ctx : Click context object.
+ * See #oximeter5_t object definition for detailed explanation.
+ * @param[in] reg : Start register address.
+ * @param[out] rx_buf : Output read data, valid in the callback.
+ * It must be word aligned and have room for @c rx_len rounded up to whole words.
+ * @param[in] rx_len : Number of bytes to be read.
+ * @param[in] callback : Function called when the read is finished, may be NULL.
+ * @param[in] arg : Argument for the callback.
+ * @return @li @c  0 - Success,
+ *         @li @c -1 - Error, another operation is active or the queue is full.
+ *
+ * See #oximeter5_return_value_t definition for detailed explanation.
+ * @note The bytes are moved into @c rx_buf by the receive DMA of the I2C job
+ * queue in whole words, so the bytes after @c rx_len up to the next word
+ * boundary are overwritten. Read single registers into a @c uint32.
+ */
+oximeter5_return_value_t oximeter5_generic_read_async ( oximeter5_t *ctx, uint8 reg, uint8 *rx_buf, uint8 rx_len, oximeter5_callback_t callback, void *arg );
+
+/**
+ * @brief Oximeter 5 non-blocking read raw FIFO burst function.
+ * @details This function reads the FIFO pointers and the overflow counter
+ * and all pending samples, up to @c max_samples, and returns at once.
+ * The transfers are done by the I2C interrupts and the callback is called
+ * when all pending samples are read. All pending samples are read in one
+ * I2C transaction, as FIFO_DATA does not autoincrement. The received FIFO bytes are left in
+ * @c raw_buf, they are moved into the buffer by the receive DMA of the
+ * I2C job queue without CPU copies.
+ * @param[in] ctx : Click context object.
+ * See #oximeter5_t object definition for detailed explanation.
+ * @param[out] raw_buf : FIFO bytes, #OXIMETER5_FIFO_SAMPLE_SIZE per sample.
+ * It must be word aligned and hold #OXIMETER5_FIFO_RAW_SIZE bytes.
+ * @param[in] max_samples : Max number of samples to read, at most #OXIMETER5_FIFO_DEPTH.
+ * @param[out] n_samples : Number of samples read.
+ * @param[out] n_overflow : Number of samples lost because the FIFO was full.
+ * @param[in] callback : Function called when the read is finished, may be NULL.
+ * @param[in] arg : Argument for the callback.
+ * @return @li @c  0 - Success,
+ *         @li @c -1 - Error, another operation is active or the queue is full.
+ *
+ * See #oximeter5_return_value_t definition for detailed explanation.
+ * @note Use #oximeter5_unpack_sample to convert the samples.
+ */
+oximeter5_return_value_t oximeter5_read_fifo_raw_async ( oximeter5_t *ctx, uint8 *raw_buf, uint8 max_samples, uint8 *n_samples, uint8 *n_overflow, oximeter5_callback_t callback, void *arg );
+
+/**
+ * @brief Oximeter 5 unpack sample function.
+ * @details This function converts one FIFO sample of
+ * #OXIMETER5_FIFO_SAMPLE_SIZE bytes into the 18 bit IR and red ADC values.
+ * @param[in] rx_buf : FIFO bytes of the sample.
+ * @param[out] ir : IR ADC data.
+ * @param[out] red : Red ADC data.
+ * @return Nothing.
+ * @note None.
+ */
+void oximeter5_unpack_sample ( uint8 *rx_buf, uint32 *ir, uint32 *red );
+
 /**
  * @brief Oximeter 5 get oxygen saturation function.
  * @details This function get oxygen saturation data
@@ -509,6 +702,139 @@ oximeter5_return_value_t oximeter5_get_oxygen_saturation ( uint32 *pun_ir_buffer
  */
 oximeter5_return_value_t oximeter5_get_heart_rate ( uint32 *pun_ir_buffer, sint32 n_ir_buffer_length, uint32 *pun_red_buffer, sint32 *pn_heart_rate );
 
+/**
+ * @brief Oximeter 5 find valleys function.
+ * @details This function calculates the detection threshold of the
+ * DC-removed, inverted and smoothed IR signal and finds at most
+ * #OXIMETER5_MAX_VALLEYS valleys in it, sorted by ascending location.
+ * @param[in] pn_x : DC-removed, inverted and smoothed IR signal.
+ * @param[in] n_size : Number of samples in the signal.
+ * @param[out] pn_valley_locs : Valley locations, at least #OXIMETER5_MAX_VALLEYS entries.
+ * @param[out] pn_npks : Number of valleys found.
+ * @return Nothing.
+ *
+ * @note This is the shared valley detection stage of
+ * #oximeter5_get_oxygen_saturation and #oximeter5_get_heart_rate.
+ */
+void oximeter5_find_valleys ( sint32 *pn_x, sint32 n_size, sint32 *pn_valley_locs, sint32 *pn_npks );
+
+/**
+ * @brief Oximeter 5 calculate heart rate function.
+ * @details This function calculates the heart rate from the mean
+ * distance of the valleys found by #oximeter5_find_valleys.
+ * @param[in] pn_valley_locs : Valley locations.
+ * @param[in] n_npks : Number of valleys.
+ * @param[out] pn_heart_rate : Heart rate data.
+ * @return @li @c  0 - Success,
+ *         @li @c -1 - Error.
+ *
+ * See #oximeter5_return_value_t definition for detailed explanation.
+ * @note None.
+ */
+oximeter5_return_value_t oximeter5_calc_heart_rate ( sint32 *pn_valley_locs, sint32 n_npks, sint32 *pn_heart_rate );
+
+/**
+ * @brief Oximeter 5 calculate oxygen saturation function.
+ * @details This function calculates the oxygen saturation from the AC/DC
+ * ratio of the raw IR and red signals between the valleys found by
+ * #oximeter5_find_valleys.
+ * @param[in] pun_ir_buffer : IR ADC data buffer pointer.
+ * @param[in] pun_red_buffer : Red ADC data buffer pointer.
+ * @param[in] n_buffer_length : Number of samples in both buffers.
+ * @param[in] pn_valley_locs : Valley locations.
+ * @param[in] n_npks : Number of valleys.
+ * @param[out] pn_spo2 : SpO2 Oxygen saturation data, from 0 percent to 100 percent.
+ * @return @li @c  0 - Success,
+ *         @li @c -1 - Error.
+ *
+ * See #oximeter5_return_value_t definition for detailed explanation.
+ * @note The buffers are read in place, no copy is made.
+ */
+oximeter5_return_value_t oximeter5_calc_oxygen_saturation ( uint32 *pun_ir_buffer, uint32 *pun_red_buffer, sint32 n_buffer_length, sint32 *pn_valley_locs, sint32 n_npks, uint8 *pn_spo2 );
+
+/**
+ * @brief Oximeter 5 select valleys function.
+ * @details This function is the last stage of #oximeter5_find_valleys: it
+ * drops the shallower one of two valleys closer than
+ * #OXIMETER5_MIN_VALLEY_DISTANCE samples and sorts the remaining valleys
+ * by ascending location.
+ * @param[in] pn_x : DC-removed, inverted and smoothed IR signal, only read at the valley locations.
+ * @param[in,out] pn_valley_locs : Valley locations above the threshold, sorted by ascending location.
+ * @param[in,out] pn_npks : Number of valleys, at most #OXIMETER5_MAX_VALLEYS.
+ * @return Nothing.
+ * @note None.
+ */
+void oximeter5_select_valleys ( sint32 *pn_x, sint32 *pn_valley_locs, sint32 *pn_npks );
+
+/**
+ * @brief Oximeter 5 calculate valley ratio function.
+ * @details This function calculates the AC/DC ratio of the raw red and IR
+ * signals of one beat, between two consecutive valleys.
+ * @param[in] pun_ir_buffer : IR ADC data buffer pointer.
+ * @param[in] pun_red_buffer : Red ADC data buffer pointer.
+ * @param[in] n_start : Location of the first valley.
+ * @param[in] n_end : Location of the next valley.
+ * @param[out] pn_ratio : AC/DC ratio X100, only written if a ratio is found.
+ * @return TRUE if the beat gives a ratio.
+ * @note The result only depends on the samples between both valleys.
+ */
+boolean oximeter5_calc_valley_ratio ( uint32 *pun_ir_buffer, uint32 *pun_red_buffer, sint32 n_start, sint32 n_end, sint32 *pn_ratio );
+
+/**
+ * @brief Oximeter 5 calculate oxygen saturation from ratios function.
+ * @details This function looks up the oxygen saturation of the median of
+ * the AC/DC ratios found by #oximeter5_calc_valley_ratio.
+ * @param[in,out] pn_ratio : AC/DC ratios, sorted in place.
+ * @param[in] n_ratio_count : Number of ratios, at most #OXIMETER5_MAX_RATIOS.
+ * @param[out] pn_spo2 : SpO2 Oxygen saturation data, from 0 percent to 100 percent.
+ * @param[out] pn_ratio_average : Median AC/DC ratio.
+ * @return @li @c  0 - Success,
+ *         @li @c -1 - Error.
+ *
+ * See #oximeter5_return_value_t definition for detailed explanation.
+ * @note None.
+ */
+oximeter5_return_value_t oximeter5_calc_spo2_from_ratios ( sint32 *pn_ratio, sint32 n_ratio_count, uint8 *pn_spo2, sint32 *pn_ratio_average );
+
+/**
+ * @brief Oximeter 5 analyze window function.
+ * @details This function calculates heart rate and oxygen saturation of
+ * one window in a single pass: the IR signal is DC-removed, inverted and
+ * smoothed once, the valleys are detected once and both values are
+ * calculated from them.
+ * @param[in] pun_ir_buffer : IR ADC data buffer pointer.
+ * @param[in] pun_red_buffer : Red ADC data buffer pointer.
+ * @param[in] n_buffer_length : Number of samples in both buffers, at most #BUFFER_SIZE.
+ * @param[out] p_result : Analysis result.
+ * See #oximeter5_analysis_t object definition for detailed explanation.
+ * @return @li @c  0 - Success,
+ *         @li @c -1 - Error, at least one value could not be calculated.
+ *
+ * See #oximeter5_return_value_t definition for detailed explanation.
+ * @note Gives the same values as #oximeter5_get_oxygen_saturation and
+ * #oximeter5_get_heart_rate called on the same buffers.
+ */
+oximeter5_return_value_t oximeter5_analyze_window ( uint32 *pun_ir_buffer, uint32 *pun_red_buffer, sint32 n_buffer_length, oximeter5_analysis_t *p_result );
+
+/**
+ * @brief Oximeter 5 analyze signal function.
+ * @details This function is the part of #oximeter5_analyze_window that
+ * follows the preprocessing. It is used by callers that keep the
+ * DC-removed, inverted and smoothed IR signal up to date themselves.
+ * @param[in] pn_x : DC-removed, inverted and smoothed IR signal.
+ * @param[in] pun_ir_buffer : IR ADC data buffer pointer.
+ * @param[in] pun_red_buffer : Red ADC data buffer pointer.
+ * @param[in] n_buffer_length : Number of samples in the signal and both buffers.
+ * @param[out] p_result : Analysis result, @c ir_mean is left untouched.
+ * See #oximeter5_analysis_t object definition for detailed explanation.
+ * @return @li @c  0 - Success,
+ *         @li @c -1 - Error, at least one value could not be calculated.
+ *
+ * See #oximeter5_return_value_t definition for detailed explanation.
+ * @note None.
+ */
+oximeter5_return_value_t oximeter5_analyze_signal ( sint32 *pn_x, uint32 *pun_ir_buffer, uint32 *pun_red_buffer, sint32 n_buffer_length, oximeter5_analysis_t *p_result );
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,553 @@
+/*
+ * oximeter5_dsp.c
+ *
+ *  Created on: 11.01.2024
+ *      Author: Andreas Reichenauer
+ *
+ * modified version of the MikroSDK Oximeter5 Click API from GitHub
+ * https://github.com/MikroElektronika/mikrosdk_click_v2/blob/master/clicks/oximeter5/lib_oximeter5/src/oximeter5.c
+ */
+
+/****************************************************************************
+** Copyright (C) 2020 MikroElektronika d.o.o.
+** Contact: https://www.mikroe.com/contact
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+** copies of the Software, and to permit persons to whom the Software is
+** furnished to do so, subject to the following conditions:
+** The above copyright notice and this permission notice shall be
+** included in all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+** EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+** OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+** IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+** DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT
+** OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+**  USE OR OTHER DEALINGS IN THE SOFTWARE.
+****************************************************************************/
+
+/*!
+ * @file oximeter5_dsp.c
+ * @brief Heart rate and SpO2 calculation functions of the Oximeter 5 Click Driver.
+ * The file is compiled a second time by hr_and_spo2_flash_copy.c, so it only contains the calculation functions.
+ */
+
+#include "oximeter5_click.h"
+#include "memory_placement.h"         //Placement of the calculation functions
+
+#define OXIMETER5_N_X_DC_MAX        -16777216
+
+static const uint8 uch_spo2_table[ 184 ] =
+{
+    95, 95, 95, 96, 96, 96, 97, 97, 97, 97, 97, 98, 98, 98, 98, 98, 99, 99, 99, 99,
+    99, 99, 99, 99, 100, 100, 100, 100, 100, 100, 100, 100, 100, 100, 100, 100, 100,
+    100, 100, 100, 100, 100, 100, 100, 99, 99, 99, 99, 99, 99, 99, 99, 98, 98, 98,
+    98, 98, 98, 97, 97, 97, 97, 96, 96, 96, 96, 95, 95, 95, 94, 94, 94, 93, 93, 93,
+    92, 92, 92, 91, 91, 90, 90, 89, 89, 89, 88, 88, 87, 87, 86, 86, 85, 85, 84, 84,
+    83, 82, 82, 81, 81, 80, 80, 79, 78, 78, 77, 76, 76, 75, 74, 74, 73, 72, 72, 71,
+    70, 69, 69, 68, 67, 66, 66, 65, 64, 63, 62, 62, 61, 60, 59, 58, 57, 56, 56, 55,
+    54, 53, 52, 51, 50, 49, 48, 47, 46, 45, 44, 43, 42, 41, 40, 39, 38, 37, 36, 35,
+    34, 33, 31, 30, 29, 28, 27, 26, 25, 23, 22, 21, 20, 19, 17, 16, 15, 14, 12, 11,
+    10, 9, 7, 6, 5, 3, 2, 1
+};
+
+/**
+ * @brief Oximeter 5 DC removal and smoothing function.
+ * @details This function removes the DC mean of the IR signal, inverts it and applies a 4 point moving average.
+ */
+static void dev_remove_dc_and_smooth ( uint32 *pun_ir_buffer, sint32 n_ir_buffer_length, sint32 *pn_x );
+
+/**
+ * @brief Oximeter 5 threshold function.
+ * @details This function calculates the valley detection threshold, limited to 30..60.
+ */
+static sint32 dev_calc_threshold ( sint32 *pn_x, sint32 n_size );
+
+/**
+ * @brief Oximeter 5 find valleys function.
+ * @details This function finds at most OXIMETER5_MAX_VALLEYS valleys above the threshold.
+ */
+static void dev_find_valleys ( sint32 *pn_x, sint32 n_size, sint32 n_th1, sint32 *pn_valley_locs, sint32 *pn_npks );
+
+/**
+ * @brief Oximeter 5 SpO2 function.
+ * @details This function calculates the SpO2 value and reports the number and median of the used AC/DC ratios.
+ */
+static oximeter5_return_value_t dev_calc_spo2 ( uint32 *pun_ir_buffer, uint32 *pun_red_buffer, sint32 n_buffer_length, sint32 *pn_valley_locs, sint32 n_npks, uint8 *pn_spo2, sint32 *pn_ratio_count, sint32 *pn_ratio_average );
+
+/**
+ * @brief Oximeter 5 find peaks above n_min_height function.
+ * @details This function find all peaks above MIN_HEIGHT.
+ */
+static void dev_peaks_above_min_height ( sint32 *pn_locs, sint32 *n_npks,  sint32  *pn_x, uint8 n_size, sint32 n_min_height );
+
+/**
+ * @brief Oximeter 5 sort indices function.
+ * @details This function sort indices according to descending order ( insertion sort algorithm ).
+ */
+static void dev_sort_indices_descend ( sint32 *pn_x, sint32 *pn_indx, sint32 n_size );
+
+/**
+ * @brief Oximeter 5 sort array function.
+ * @details This function array in ascending order ( insertion sort algorithm ).
+ */
+static void dev_sort_ascend ( sint32  *pn_x, sint32 n_size );
+
+/**
+ * @brief Oximeter 5 remove peaks function.
+ * @details This function remove peaks separated by less than MIN_DISTANCE.
+ */
+static void dev_remove_close_peaks ( sint32 *pn_locs, sint32 *pn_npks, sint32 *pn_x, sint32 n_min_distance );
+
+/**
+ * @brief Oximeter 5 find peaks function.
+ * @details This function find at most MAX_NUM peaks above MIN_HEIGHT separated by at least MIN_DISTANCE.
+ */
+static void dev_find_peaks ( sint32 *pn_locs, sint32 *n_npks,  sint32  *pn_x, uint8 n_size, sint32 n_min_height, sint32 n_min_distance, sint32 n_max_num );
+
+HR_AND_SPO2_DSP_CODE oximeter5_return_value_t oximeter5_get_oxygen_saturation ( uint32 *pun_ir_buffer, sint32 n_ir_buffer_length, uint32 *pun_red_buffer, uint8 *pn_spo2 )
+{
+    sint32 n_npks;
+    sint32 an_ir_valley_locs[ OXIMETER5_MAX_VALLEYS ];
+    sint32 an_x[ BUFFER_SIZE ];
+
+    // remove DC, invert and smooth IR signal so that we can use peak detector as valley detector
+    dev_remove_dc_and_smooth( pun_ir_buffer, n_ir_buffer_length, an_x );
+
+    // since we flipped signal, we use peak detector as valley detector
+    oximeter5_find_valleys( an_x, n_ir_buffer_length, an_ir_valley_locs, &n_npks );
+
+    return oximeter5_calc_oxygen_saturation( pun_ir_buffer, pun_red_buffer, n_ir_buffer_length, an_ir_valley_locs, n_npks, pn_spo2 );
+}
+
+HR_AND_SPO2_DSP_CODE oximeter5_return_value_t oximeter5_get_heart_rate ( uint32 *pun_ir_buffer, sint32 n_ir_buffer_length, uint32 *pun_red_buffer, sint32 *pn_heart_rate )
+{
+    sint32 n_npks;
+    sint32 an_ir_valley_locs[ OXIMETER5_MAX_VALLEYS ];
+    sint32 an_x[ BUFFER_SIZE ];
+
+    // remove DC, invert and smooth IR signal so that we can use peak detector as valley detector
+    dev_remove_dc_and_smooth( pun_ir_buffer, n_ir_buffer_length, an_x );
+
+    // since we flipped signal, we use peak detector as valley detector
+    oximeter5_find_valleys( an_x, n_ir_buffer_length, an_ir_valley_locs, &n_npks );
+
+    return oximeter5_calc_heart_rate( an_ir_valley_locs, n_npks, pn_heart_rate );
+}
+
+HR_AND_SPO2_DSP_CODE void oximeter5_find_valleys ( sint32 *pn_x, sint32 n_size, sint32 *pn_valley_locs, sint32 *pn_npks )
+{
+    dev_find_valleys( pn_x, n_size, dev_calc_threshold( pn_x, n_size ), pn_valley_locs, pn_npks );
+}
+
+HR_AND_SPO2_DSP_CODE oximeter5_return_value_t oximeter5_calc_heart_rate ( sint32 *pn_valley_locs, sint32 n_npks, sint32 *pn_heart_rate )
+{
+    sint32 n_peak_interval_sum;
+    oximeter5_return_value_t error_flag;
+
+    n_peak_interval_sum = 0;
+
+    if ( n_npks >= 2 )
+    {
+        for ( sint32 n_cnt_k = 1; n_cnt_k < n_npks; n_cnt_k++ )
+        {
+            n_peak_interval_sum += ( pn_valley_locs[ n_cnt_k ] - pn_valley_locs[ n_cnt_k - 1 ] );
+        }
+
+        n_peak_interval_sum = n_peak_interval_sum / ( n_npks - 1 );
+        *pn_heart_rate = ( sint32 ) ( ( SAMPLING_FREQUENCY * 60 ) / n_peak_interval_sum );
+        error_flag  = OXIMETER5_OK;
+    }
+    else
+    {
+        *pn_heart_rate = OXIMETER5_HEART_RATE_ERROR_DATA; // unable to calculate because # of peaks are too small
+        error_flag  = OXIMETER5_ERROR;
+    }
+
+    return error_flag;
+}
+
+HR_AND_SPO2_DSP_CODE oximeter5_return_value_t oximeter5_calc_oxygen_saturation ( uint32 *pun_ir_buffer, uint32 *pun_red_buffer, sint32 n_buffer_length, sint32 *pn_valley_locs, sint32 n_npks, uint8 *pn_spo2 )
+{
+    sint32 n_ratio_count, n_ratio_average;
+
+    return dev_calc_spo2( pun_ir_buffer, pun_red_buffer, n_buffer_length, pn_valley_locs, n_npks, pn_spo2, &n_ratio_count, &n_ratio_average );
+}
+
+HR_AND_SPO2_DSP_CODE oximeter5_return_value_t oximeter5_analyze_window ( uint32 *pun_ir_buffer, uint32 *pun_red_buffer, sint32 n_buffer_length, oximeter5_analysis_t *p_result )
+{
+    uint32 un_ir_mean;
+    uint32 un_ir_ma4_sum;
+    sint32 an_x[ BUFFER_SIZE ];
+
+    // calculates DC mean
+    un_ir_mean = 0;
+    for ( sint32 n_cnt_k = 0; n_cnt_k < n_buffer_length; n_cnt_k++ )
+    {
+        un_ir_mean += pun_ir_buffer[ n_cnt_k ];
+    }
+
+    un_ir_mean = un_ir_mean / n_buffer_length;
+
+    // remove DC, invert and apply 4 pt Moving Average in one pass with a running sum of the next MA4_SIZE samples
+    un_ir_ma4_sum = pun_ir_buffer[ 0 ] + pun_ir_buffer[ 1 ] + pun_ir_buffer[ 2 ];
+    for ( sint32 n_cnt_k = 0; n_cnt_k < n_buffer_length - MA4_SIZE; n_cnt_k++ )
+    {
+        un_ir_ma4_sum += pun_ir_buffer[ n_cnt_k + MA4_SIZE - 1 ];
+        an_x[ n_cnt_k ] = ( ( sint32 ) ( MA4_SIZE * un_ir_mean ) - ( sint32 ) un_ir_ma4_sum ) / MA4_SIZE;
+        un_ir_ma4_sum -= pun_ir_buffer[ n_cnt_k ];
+    }
+
+    // last samples have no complete average
+    for ( sint32 n_cnt_k = n_buffer_length - MA4_SIZE; n_cnt_k < n_buffer_length; n_cnt_k++ )
+    {
+        an_x[ n_cnt_k ] = ( sint32 ) un_ir_mean - ( sint32 ) pun_ir_buffer[ n_cnt_k ];
+    }
+
+    p_result->ir_mean = un_ir_mean;
+
+    return oximeter5_analyze_signal( an_x, pun_ir_buffer, pun_red_buffer, n_buffer_length, p_result );
+}
+
+HR_AND_SPO2_DSP_CODE oximeter5_return_value_t oximeter5_analyze_signal ( sint32 *pn_x, uint32 *pun_ir_buffer, uint32 *pun_red_buffer, sint32 n_buffer_length, oximeter5_analysis_t *p_result )
+{
+    // since we flipped signal, we use peak detector as valley detector, valleys are used for both values
+    p_result->threshold = dev_calc_threshold( pn_x, n_buffer_length );
+    dev_find_valleys( pn_x, n_buffer_length, p_result->threshold, p_result->valley_locs, &p_result->valley_count );
+
+    p_result->heart_rate_error = oximeter5_calc_heart_rate( p_result->valley_locs, p_result->valley_count, &p_result->heart_rate );
+    p_result->spo2_error = dev_calc_spo2( pun_ir_buffer, pun_red_buffer, n_buffer_length, p_result->valley_locs, p_result->valley_count,
+                                          &p_result->spo2, &p_result->ratio_count, &p_result->ratio_average );
+
+    return p_result->heart_rate_error | p_result->spo2_error;
+}
+
+HR_AND_SPO2_DSP_CODE void oximeter5_select_valleys ( sint32 *pn_x, sint32 *pn_valley_locs, sint32 *pn_npks )
+{
+    dev_remove_close_peaks( pn_valley_locs, pn_npks, pn_x, OXIMETER5_MIN_VALLEY_DISTANCE );
+    if ( *pn_npks > OXIMETER5_MAX_VALLEYS )
+    {
+        *pn_npks = OXIMETER5_MAX_VALLEYS;
+    }
+}
+
+HR_AND_SPO2_DSP_CODE boolean oximeter5_calc_valley_ratio ( uint32 *pun_ir_buffer, uint32 *pun_red_buffer, sint32 n_start, sint32 n_end, sint32 *pn_ratio )
+{
+    sint32 n_y_ac, n_x_ac;
+    sint32 n_y_dc_max, n_x_dc_max;
+    sint32 n_y_dc_max_idx, n_x_dc_max_idx;
+    sint32 n_nume, n_denom ;
+
+    // raw values are used for SPO2 calculation : RED(=y) and IR(=X), they are read in place instead of copied
+    sint32 *an_x = ( sint32 * ) pun_ir_buffer;
+    sint32 *an_y = ( sint32 * ) pun_red_buffer;
+
+    if ( n_end - n_start <= 3 )
+    {
+        return FALSE;
+    }
+
+    n_y_dc_max= OXIMETER5_N_X_DC_MAX;
+    n_x_dc_max= OXIMETER5_N_X_DC_MAX;
+
+    for ( sint32 n_cnt_i = n_start; n_cnt_i < n_end; n_cnt_i++ )
+    {
+        if ( an_x[ n_cnt_i ] > n_x_dc_max )
+        {
+            n_x_dc_max = an_x[ n_cnt_i ];
+            n_x_dc_max_idx = n_cnt_i;
+        }
+
+        if ( an_y[ n_cnt_i ] > n_y_dc_max )
+        {
+            n_y_dc_max = an_y[ n_cnt_i ];
+            n_y_dc_max_idx = n_cnt_i;
+
+        }
+    }
+
+    //red
+    n_y_ac = ( an_y[ n_end ] - an_y[ n_start ] ) * ( n_y_dc_max_idx - n_start );
+    n_y_ac =  an_y[ n_start ] + n_y_ac / ( n_end - n_start );
+    // subracting linear DC compoenents from raw
+    n_y_ac =  an_y[ n_y_dc_max_idx ] - n_y_ac;
+    // ir
+    n_x_ac = ( an_x[ n_end ] - an_x[ n_start ] ) * ( n_x_dc_max_idx - n_start );
+    // subracting linear DC compoenents from raw
+    n_x_ac =  an_x[ n_start ] + n_x_ac / ( n_end - n_start );
+    n_x_ac =  an_x[ n_y_dc_max_idx ] - n_x_ac;
+    //prepare X100 to preserve floating value
+    n_nume =( n_y_ac * n_x_dc_max ) >> 7;
+    n_denom = ( n_x_ac * n_y_dc_max ) >> 7;
+
+    if ( ( n_denom > 0 ) && ( n_nume != 0 ) )
+    {
+        *pn_ratio = ( n_nume * 100 ) / n_denom;
+        return TRUE;
+    }
+
+    return FALSE;
+}
+
+HR_AND_SPO2_DSP_CODE oximeter5_return_value_t oximeter5_calc_spo2_from_ratios ( sint32 *pn_ratio, sint32 n_ratio_count, uint8 *pn_spo2, sint32 *pn_ratio_average )
+{
+    sint32 n_middle_idx;
+    sint32 n_spo2_calc;
+    sint32 n_ratio_average;
+    oximeter5_return_value_t error_flag;
+
+    // choose median value since PPG signal may varies from beat to beat
+    dev_sort_ascend( pn_ratio, n_ratio_count );
+    n_middle_idx = n_ratio_count / 2;
+    n_ratio_average = 0;
+
+    if ( n_middle_idx > 1 )
+    {
+        // use median
+        n_ratio_average = ( pn_ratio[ n_middle_idx - 1 ] + pn_ratio[ n_middle_idx ] ) / 2;
+    }
+    else if ( n_ratio_count > 0 )
+    {
+        n_ratio_average = pn_ratio[ n_middle_idx ];
+    }
+
+    *pn_ratio_average = n_ratio_average;
+
+    if ( ( n_ratio_average > 2 ) && ( n_ratio_average < 184 ) )
+    {
+        n_spo2_calc = uch_spo2_table[ n_ratio_average ];
+        *pn_spo2 = (uint8)n_spo2_calc;
+        error_flag = OXIMETER5_OK;
+    }
+    else
+    {
+        *pn_spo2 = OXIMETER5_PN_SPO2_ERROR_DATA;
+        error_flag  = OXIMETER5_ERROR;
+    }
+
+    return error_flag;
+}
+
+static HR_AND_SPO2_DSP_CODE oximeter5_return_value_t dev_calc_spo2 ( uint32 *pun_ir_buffer, uint32 *pun_red_buffer, sint32 n_buffer_length, sint32 *pn_valley_locs, sint32 n_npks, uint8 *pn_spo2, sint32 *pn_ratio_count, sint32 *pn_ratio_average )
+{
+    sint32 n_i_ratio_count;
+    sint32 n_exact_ir_valley_locs_count;
+    sint32 an_ratio[ OXIMETER5_MAX_RATIOS ];
+    oximeter5_return_value_t error_flag;
+
+    // find precise min near an_ir_valley_locs
+    n_exact_ir_valley_locs_count = n_npks;
+
+    //using exact_ir_valley_locs , find ir-red DC andir-red AC for SPO2 calibration an_ratio
+    //finding AC/DC maximum of raw
+    n_i_ratio_count = 0;
+
+    for ( sint32 n_cnt_k = 0; n_cnt_k < OXIMETER5_MAX_RATIOS; n_cnt_k++ )
+    {
+        an_ratio[ n_cnt_k ] = 0;
+    }
+
+    for ( sint32 n_cnt_k = 0; n_cnt_k < n_exact_ir_valley_locs_count; n_cnt_k++ )
+    {
+        if ( pn_valley_locs[ n_cnt_k ] > n_buffer_length )
+        {
+            // do not use SPO2 since valley loc is out of range
+            *pn_spo2 = OXIMETER5_PN_SPO2_ERROR_DATA;
+            error_flag  = OXIMETER5_ERROR;
+        }
+    }
+
+    // find max between two valley locations
+    // and use an_ratio betwen AC compoent of Ir & Red and DC compoent of Ir & Red for SPO2
+    for ( sint32 n_cnt_k = 0; n_cnt_k < n_exact_ir_valley_locs_count - 1; n_cnt_k++ )
+    {
+        if ( ( n_i_ratio_count < OXIMETER5_MAX_RATIOS ) &&
+             oximeter5_calc_valley_ratio( pun_ir_buffer, pun_red_buffer, pn_valley_locs[ n_cnt_k ], pn_valley_locs[ n_cnt_k + 1 ], &an_ratio[ n_i_ratio_count ] ) )
+        {
+            n_i_ratio_count++;
+        }
+    }
+
+    *pn_ratio_count = n_i_ratio_count;
+
+    // choose median value since PPG signal may varies from beat to beat
+    error_flag = oximeter5_calc_spo2_from_ratios( an_ratio, n_i_ratio_count, pn_spo2, pn_ratio_average );
+
+    return error_flag;
+}
+
+static HR_AND_SPO2_DSP_CODE sint32 dev_calc_threshold ( sint32 *pn_x, sint32 n_size )
+{
+    sint32 n_th1;
+
+    // calculate threshold
+    n_th1 = 0;
+    for ( sint32 n_cnt_k = 0; n_cnt_k < n_size; n_cnt_k++ )
+    {
+        n_th1 +=  pn_x[ n_cnt_k ];
+    }
+
+    n_th1 = n_th1 / n_size;
+
+    if ( n_th1 < OXIMETER5_MIN_THRESHOLD )
+    {
+        n_th1 = OXIMETER5_MIN_THRESHOLD; // min allowed
+    }
+
+    if ( n_th1 > OXIMETER5_MAX_THRESHOLD )
+    {
+        n_th1 = OXIMETER5_MAX_THRESHOLD; // max allowed
+    }
+
+    return n_th1;
+}
+
+static HR_AND_SPO2_DSP_CODE void dev_find_valleys ( sint32 *pn_x, sint32 n_size, sint32 n_th1, sint32 *pn_valley_locs, sint32 *pn_npks )
+{
+    for ( sint32 n_cnt_k = 0; n_cnt_k < OXIMETER5_MAX_VALLEYS; n_cnt_k++ )
+    {
+        pn_valley_locs[ n_cnt_k ] = 0;
+    }
+
+    dev_find_peaks( pn_valley_locs, pn_npks, pn_x, n_size, n_th1, OXIMETER5_MIN_VALLEY_DISTANCE, OXIMETER5_MAX_VALLEYS );//peak_height, peak_distance, max_num_peaks
+}
+
+static HR_AND_SPO2_DSP_CODE void dev_remove_dc_and_smooth ( uint32 *pun_ir_buffer, sint32 n_ir_buffer_length, sint32 *pn_x )
+{
+    uint32 un_ir_mean;
+
+    // calculates DC mean and subtract DC from ir
+    un_ir_mean = 0;
+    for ( sint32 n_cnt_k = 0; n_cnt_k < n_ir_buffer_length; n_cnt_k++ )
+    {
+        un_ir_mean += pun_ir_buffer[ n_cnt_k ];
+    }
+
+    un_ir_mean = un_ir_mean / n_ir_buffer_length;
+
+    // remove DC and invert signal so that we can use peak detector as valley detector
+    for ( sint32 n_cnt_k = 0; n_cnt_k < n_ir_buffer_length; n_cnt_k++ )
+    {
+        pn_x[ n_cnt_k ] = -1 * ( pun_ir_buffer[ n_cnt_k ] - un_ir_mean );
+    }
+
+    // 4 pt Moving Average
+    for( sint32 n_cnt_k = 0; n_cnt_k < n_ir_buffer_length - MA4_SIZE; n_cnt_k++ )
+    {
+        pn_x[ n_cnt_k ]=( pn_x[ n_cnt_k ] + pn_x[ n_cnt_k + 1 ] + pn_x[ n_cnt_k + 2 ] + pn_x[ n_cnt_k + 3 ] ) / 4;
+    }
+}
+
+static HR_AND_SPO2_DSP_CODE void dev_peaks_above_min_height ( sint32 *pn_locs, sint32 *n_npks,  sint32  *pn_x, uint8 n_size, sint32 n_min_height )
+{
+    uint8 n_width;
+    uint8 n_cnt = 1;
+
+    *n_npks = 0;
+
+    while ( n_cnt < ( n_size - 1 ) )
+    {
+        if ( pn_x[ n_cnt ] > n_min_height && pn_x[ n_cnt ] > pn_x[ n_cnt - 1 ] )
+        {
+            n_width = 1;
+
+            while ( n_cnt + n_width < n_size && pn_x[ n_cnt ] == pn_x[ n_cnt + n_width ] )
+            {
+                n_width++;
+            }
+
+            // a plateau reaching the end of the signal is not a peak
+            if ( n_cnt + n_width < n_size && pn_x[ n_cnt ] > pn_x[ n_cnt + n_width ] && ( *n_npks ) < OXIMETER5_MAX_VALLEYS )
+            {
+                pn_locs[( *n_npks )++ ] = n_cnt;
+                n_cnt += n_width + 1;
+            }
+            else
+            {
+                n_cnt += n_width;
+            }
+        }
+        else
+        {
+            n_cnt++;
+        }
+    }
+}
+
+
+static HR_AND_SPO2_DSP_CODE void dev_sort_indices_descend ( sint32 *pn_x, sint32 *pn_indx, sint32 n_size )
+{
+    sint32 n_temp;
+
+    for ( sint32 n_cnt_i = 1; n_cnt_i < n_size; n_cnt_i++ )
+    {
+        n_temp = pn_indx[ n_cnt_i ];
+
+        sint32 n_cnt_j;
+        for ( n_cnt_j = n_cnt_i; n_cnt_j > 0 && pn_x[ n_temp ] > pn_x[ pn_indx[ n_cnt_j - 1 ] ]; n_cnt_j-- )
+        {
+            pn_indx[ n_cnt_j ] = pn_indx[ n_cnt_j - 1 ];
+        }
+
+        pn_indx[ n_cnt_j ] = n_temp;
+    }
+}
+
+static HR_AND_SPO2_DSP_CODE void dev_sort_ascend ( sint32  *pn_x, sint32 n_size )
+{
+    sint32 n_temp;
+
+    for ( sint32 n_cnt_i = 1; n_cnt_i < n_size; n_cnt_i++ )
+    {
+        n_temp = pn_x[ n_cnt_i ];
+
+        sint32 n_cnt_j;
+        for ( n_cnt_j = n_cnt_i; n_cnt_j > 0 && n_temp < pn_x[ n_cnt_j - 1 ]; n_cnt_j-- )
+        {
+            pn_x[ n_cnt_j ] = pn_x[ n_cnt_j - 1 ];
+        }
+
+        pn_x[ n_cnt_j ] = n_temp;
+    }
+}
+
+static HR_AND_SPO2_DSP_CODE void dev_remove_close_peaks ( sint32 *pn_locs, sint32 *pn_npks, sint32 *pn_x, sint32 n_min_distance )
+{
+    sint32 n_old_npks, n_dist;
+
+    dev_sort_indices_descend( pn_x, pn_locs, *pn_npks );
+
+    for ( sint32 n_cnt_i = -1; n_cnt_i < *pn_npks; n_cnt_i++ )
+    {
+        n_old_npks = *pn_npks;
+        *pn_npks = n_cnt_i + 1;
+
+        for ( sint32 n_cnt_j = n_cnt_i + 1; n_cnt_j < n_old_npks; n_cnt_j++ )
+        {
+            n_dist =  pn_locs[ n_cnt_j ] - ( n_cnt_i == -1 ? -1 : pn_locs[ n_cnt_i ] );
+
+            if ( n_dist > n_min_distance || n_dist < -n_min_distance )
+            {
+                pn_locs[ (*pn_npks)++ ] = pn_locs[ n_cnt_j ];
+            }
+        }
+    }
+
+    dev_sort_ascend( pn_locs, *pn_npks );
+}
+
+static HR_AND_SPO2_DSP_CODE void dev_find_peaks ( sint32 *pn_locs, sint32 *n_npks,  sint32  *pn_x, uint8 n_size, sint32 n_min_height, sint32 n_min_distance, sint32 n_max_num )
+{
+    dev_peaks_above_min_height( pn_locs, n_npks, pn_x, n_size, n_min_height );
+    dev_remove_close_peaks( pn_locs, n_npks, pn_x, n_min_distance );
+    if ( *n_npks > n_max_num )
+    {
+        *n_npks = n_max_num;
+    }
+}
+
+// ------------------------------------------------------------------------- END
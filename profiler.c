@@ -0,0 +1,116 @@
+/*
+ * profiler.c
+ *
+ *  Created on: 17.10.2026
+ *      Author: Andreas Reichenauer
+ */
+
+#include <IfxCpu.h>
+#include <profiler.h>
+#include <memory_placement.h>
+
+/*************************************************************************************************************/
+/*------------------------------------------------------Macros-----------------------------------------------*/
+/*************************************************************************************************************/
+#define COUNTER_MASK            0x7FFFFFFF                          // The counters are 31 bit wide
+
+/*************************************************************************************************************/
+/*-------------------------------------------------Type Definitions------------------------------------------*/
+/*************************************************************************************************************/
+typedef struct
+{
+    uint32 cycles;
+    uint32 instructions;
+    uint32 m1;
+    uint32 m2;
+    uint32 m3;
+
+} profile_start_t;
+
+typedef struct
+{
+    profile_entry_t entries[PROFILE_PROBE_COUNT];                   // Accumulated counters of the probes
+    profile_start_t starts[PROFILE_PROBE_COUNT];                    // Counters at the start of the running probes
+
+} profile_table_t;
+
+/*************************************************************************************************************/
+/*-------------------------------------------------Global variables------------------------------------------*/
+/*************************************************************************************************************/
+// each core updates its table in its own DSPR, the dump reads them over the non-cached global addresses
+static profile_table_t cpu0_table CPU0_BSS;
+static profile_table_t cpu1_table CPU1_BSS;
+static profile_table_t cpu2_table CPU2_BSS;
+static profile_table_t * const core_tables[PROFILER_CORE_COUNT] = {&cpu0_table, &cpu1_table, &cpu2_table};
+
+static const char * const probe_names[PROFILE_PROBE_COUNT] = {
+    "read_and_calculate_values",
+    "oximeter5_check_interrupt",
+    "oximeter5_read_fifo_raw_async",
+    "oximeter5_unpack_sample",
+    "hr_and_spo2_stream_evaluate",
+    "oximeter5_analyze_window",
+    "pipeline_window_copy",
+    "c8x8r_displayImage",
+    "telemetry_format_values"
+};
+
+/*********************************************************************************************************************/
+/*---------------------------------------------Function Implementations----------------------------------------------*/
+/*********************************************************************************************************************/
+void profiler_init(void){
+    IfxCpu_resetAndStartCounters(IfxCpu_CounterMode_normal);
+}
+
+
+void profiler_begin(profile_probe_t probe){
+    profile_start_t *start = &core_tables[IfxCpu_getCoreIndex()]->starts[probe];
+
+    // cycle counter last, so the reads of the other counters are not measured
+    start->m1 = IfxCpu_getPerformanceCounter(CPU_M1CNT);
+    start->m2 = IfxCpu_getPerformanceCounter(CPU_M2CNT);
+    start->m3 = IfxCpu_getPerformanceCounter(CPU_M3CNT);
+    start->instructions = IfxCpu_getInstructionCounter();
+    start->cycles = IfxCpu_getClockCounter();
+}
+
+
+void profiler_end(profile_probe_t probe){
+    // cycle counter first, for the same reason
+    uint32 cycles = IfxCpu_getClockCounter();
+    uint32 instructions = IfxCpu_getInstructionCounter();
+    uint32 m1 = IfxCpu_getPerformanceCounter(CPU_M1CNT);
+    uint32 m2 = IfxCpu_getPerformanceCounter(CPU_M2CNT);
+    uint32 m3 = IfxCpu_getPerformanceCounter(CPU_M3CNT);
+
+    profile_table_t *table = core_tables[IfxCpu_getCoreIndex()];
+    profile_start_t *start = &table->starts[probe];
+    profile_entry_t *entry = &table->entries[probe];
+
+    cycles = (cycles - start->cycles) & COUNTER_MASK;
+    if(entry->calls == 0 || cycles < entry->min_cycles)
+        entry->min_cycles = cycles;
+    if(cycles > entry->max_cycles)
+        entry->max_cycles = cycles;
+
+    entry->total_cycles += cycles;
+    entry->total_instructions += (instructions - start->instructions) & COUNTER_MASK;
+    entry->total_m1 += (m1 - start->m1) & COUNTER_MASK;
+    entry->total_m2 += (m2 - start->m2) & COUNTER_MASK;
+    entry->total_m3 += (m3 - start->m3) & COUNTER_MASK;
+    entry->calls++;
+}
+
+
+const profile_entry_t *profiler_get_entry(uint8 core, profile_probe_t probe){
+    if(core >= PROFILER_CORE_COUNT || probe >= PROFILE_PROBE_COUNT) return NULL_PTR;
+
+    return &core_tables[core]->entries[probe];
+}
+
+
+const char *profiler_get_probe_name(profile_probe_t probe){
+    if(probe >= PROFILE_PROBE_COUNT) return "";
+
+    return probe_names[probe];
+}
@@ -0,0 +1,112 @@
+/*
+ * profiler.h
+ *
+ *  Created on: 17.10.2026
+ *      Author: Andreas Reichenauer
+ */
+
+#ifndef PROFILER_H_
+#define PROFILER_H_
+
+#include <Ifx_Types.h>
+
+/*********************************************************************************************************************/
+/*------------------------------------------------------Macros-------------------------------------------------------*/
+/*********************************************************************************************************************/
+#define PROFILER_ENABLED            1       // Set to 0 to remove all probes from the build
+#define PROFILER_CORE_COUNT         3       // Number of cores with their own table
+#define PROFILER_DUMP_COMMAND       'p'     // Character received via UART which dumps the tables
+
+/*
+ * Probe points, placed around the measured call. A probe counts the cycles of all interrupts which preempt it,
+ * and must not be nested in itself on the same core.
+ */
+#if PROFILER_ENABLED
+#define PROFILE_BEGIN(probe)        profiler_begin(probe)
+#define PROFILE_END(probe)          profiler_end(probe)
+#else
+#define PROFILE_BEGIN(probe)
+#define PROFILE_END(probe)
+#endif
+
+/*********************************************************************************************************************/
+/*---------------------------------------------Type Definitions----------------------------------------------*/
+/*********************************************************************************************************************/
+/***
+ * @brief: named probe points, each core has its own entry for every probe
+ */
+typedef enum
+{
+    PROFILE_READ_AND_CALCULATE = 0,         // read_and_calculate_values
+    PROFILE_OXIMETER5_CHECK_INTERRUPT,      // oximeter5_check_interrupt
+    PROFILE_OXIMETER5_READ_FIFO,            // oximeter5_read_fifo_raw_async, only the start of the transfer
+    PROFILE_OXIMETER5_UNPACK_SAMPLE,        // oximeter5_unpack_sample
+    PROFILE_STREAM_EVALUATE,                // hr_and_spo2_stream_evaluate
+    PROFILE_OXIMETER5_ANALYZE_WINDOW,       // oximeter5_analyze_window of the pipeline
+    PROFILE_PIPELINE_COPY,                  // copy of the streaming window into the pipeline pool
+    PROFILE_DISPLAY_IMAGE,                  // c8x8r_displayImage
+    PROFILE_TELEMETRY_FORMAT,               // formatting of a values line by telemetry_drain
+    PROFILE_PROBE_COUNT
+
+} profile_probe_t;
+
+/***
+ * @brief: accumulated counters of one probe on one core. The multi counters count the events selected for the core
+ * type, on the TC1.6P cores (CPU1, CPU2) these are the program and data cache misses, see the CPU chapter of the
+ * user manual
+ */
+typedef struct
+{
+    uint32 calls;               // Number of finished calls
+    uint32 min_cycles;          // Fewest CPU cycles of a call
+    uint32 max_cycles;          // Most CPU cycles of a call
+    uint64 total_cycles;        // CPU cycles of all calls, divided by calls for the mean
+    uint64 total_instructions;  // Executed instructions of all calls
+    uint64 total_m1;            // Events of multi counter 1 of all calls
+    uint64 total_m2;            // Events of multi counter 2 of all calls
+    uint64 total_m3;            // Events of multi counter 3 of all calls
+
+} profile_entry_t;
+
+/*********************************************************************************************************************/
+/*---------------------------------------------Function Definitions----------------------------------------------*/
+/*********************************************************************************************************************/
+/***
+ * @brief: resets and starts the cycle, instruction and multi counters of the calling core, called once by each core
+ * @params: none
+ * @returns: void
+ */
+void profiler_init(void);
+
+/***
+ * @brief: stores the counters of the calling core at the start of a probe, use PROFILE_BEGIN
+ * @params: profile_probe_t, the probe
+ * @returns: void
+ */
+void profiler_begin(profile_probe_t probe);
+
+/***
+ * @brief: adds the counters since the start of the probe to the entry of the calling core, use PROFILE_END.
+ * A call must take less than 2^31 cycles, the width of the counters
+ * @params: profile_probe_t, the probe
+ * @returns: void
+ */
+void profiler_end(profile_probe_t probe);
+
+/***
+ * @brief: returns the entry of a probe on a core. The entry is read while the core may update it, so the totals can
+ * be one call ahead of the call count
+ * @params: uint8, the index of the core
+ * @params: profile_probe_t, the probe
+ * @returns: const profile_entry_t*, the entry, NULL if the core or probe does not exist
+ */
+const profile_entry_t *profiler_get_entry(uint8 core, profile_probe_t probe);
+
+/***
+ * @brief: returns the name of a probe
+ * @params: profile_probe_t, the probe
+ * @returns: const char*, the name of the probe
+ */
+const char *profiler_get_probe_name(profile_probe_t probe);
+
+#endif /* PROFILER_H_ */
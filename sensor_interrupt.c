@@ -0,0 +1,65 @@
+/*
+ * sensor_interrupt.c
+ *
+ *  Created on: 17.10.2026
+ *      Author: Andreas Reichenauer
+ */
+
+#include <IfxScuEru.h>
+#include <IfxSrc.h>
+#include <sensor_interrupt.h>
+
+/*************************************************************************************************************/
+/*------------------------------------------------------Macros-----------------------------------------------*/
+/*************************************************************************************************************/
+#define ISR_PRIORITY_ERU_DATA_READY   6                             // Interrupt priority for data ready, above the read timer
+#define ERU_OUTPUT_CHANNEL            IfxScuEru_OutputChannel_0     // ERU output channel connected to the interrupt
+#define ERU_SRC                       SRC_SCU_SCU_ERU0              // Service request node of the ERU output channel
+
+/*************************************************************************************************************/
+/*-------------------------------------------------Global variables------------------------------------------*/
+/*************************************************************************************************************/
+static interrupt_fptr_t interrupt_function_data_ready = NULL;      // Function used for data ready interrupt handling
+
+/*********************************************************************************************************************/
+/*---------------------------------------------Function Implementations----------------------------------------------*/
+/*********************************************************************************************************************/
+IFX_INTERRUPT(interruptDataReady, 1, ISR_PRIORITY_ERU_DATA_READY);  // Adding the data ready Interrupt Service Routine
+
+
+void interruptDataReady(void)
+{
+    if(interrupt_function_data_ready == NULL) return;               // If defined use the interrupt function for further handling
+    interrupt_function_data_ready();
+}
+
+
+void init_data_ready_interrupt(interrupt_fptr_t interrupt_function_){
+    IfxScu_Req_In *req_pin = &IfxScu_REQ9_P20_0_IN;                 // INT pin of the Oximeter 5 on CON1
+    IfxScuEru_InputChannel input_channel = (IfxScuEru_InputChannel)req_pin->channelId;
+
+    IfxScuEru_initReqPin(req_pin, IfxPort_InputMode_pullUp);        // INT is open drain and low active
+
+    // trigger on the falling edge of INT and connect the trigger to the output channel
+    IfxScuEru_selectExternalInput(input_channel, (IfxScuEru_ExternalInputSelection)req_pin->select);
+    IfxScuEru_enableFallingEdgeDetection(input_channel);
+    IfxScuEru_enableAutoClear(input_channel);
+    IfxScuEru_enableTriggerPulse(input_channel);
+    IfxScuEru_connectTrigger(input_channel, (IfxScuEru_InputNodePointer)ERU_OUTPUT_CHANNEL);
+    IfxScuEru_setInterruptGatingPattern(ERU_OUTPUT_CHANNEL, IfxScuEru_InterruptGatingPattern_alwaysActive);
+
+    IfxSrc_init(&ERU_SRC, IfxSrc_Tos_cpu1, ISR_PRIORITY_ERU_DATA_READY);
+
+    interrupt_function_data_ready = interrupt_function_;            // Set interrupt handling function
+}
+
+
+void start_data_ready_interrupt(void){
+    IfxSrc_clearRequest(&ERU_SRC);                                  // Drop edges from before the start
+    IfxSrc_enable(&ERU_SRC);                                        // Enable the service request
+}
+
+
+void stop_data_ready_interrupt(void){
+    IfxSrc_disable(&ERU_SRC);                                       // Disable the service request
+}
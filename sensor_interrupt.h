@@ -0,0 +1,45 @@
+/*
+ * sensor_interrupt.h
+ *
+ *  Created on: 17.10.2026
+ *      Author: Andreas Reichenauer
+ */
+
+#ifndef SENSOR_INTERRUPT_H_
+#define SENSOR_INTERRUPT_H_
+
+#include <sensor_timer.h>
+
+/*********************************************************************************************************************/
+/*---------------------------------------------Function Definitions----------------------------------------------*/
+/*********************************************************************************************************************/
+/***
+ * @brief: interrupt handler called whenever the sensor signals new data with a falling edge on its INT pin (P20.0)
+ * @params: None
+ * @return: void
+ */
+void interruptDataReady(void);
+
+/***
+ * @brief: routes the INT pin of the sensor through the external request unit (ERU) to an interrupt of CPU1 and also
+ * sets the function that is used inside the interrupt handler for further actions
+ * @params: interrupt_fptr_t, the type of function used for detailed interrupt handling
+ * @returns: void
+ */
+void init_data_ready_interrupt(interrupt_fptr_t interrupt_function_);
+
+/***
+ * @brief: enables the data ready interrupt
+ * @params: none
+ * @returns: void
+ */
+void start_data_ready_interrupt(void);
+
+/***
+ * @brief: disables the data ready interrupt
+ * @params: none
+ * @returns: void
+ */
+void stop_data_ready_interrupt(void);
+
+#endif /* SENSOR_INTERRUPT_H_ */
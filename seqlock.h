@@ -0,0 +1,91 @@
+/*
+ * seqlock.h
+ *
+ *  Created on: 17.10.2026
+ *      Author: Andreas Reichenauer
+ */
+
+/*!
+ * @file seqlock.h
+ * @brief This file contains the sequence counter protocol of the records one core publishes to the other cores.
+ */
+
+#ifndef SEQLOCK_H_
+#define SEQLOCK_H_
+
+#include <Ifx_Types.h>
+#include <IfxCpu_Intrinsics.h>
+
+/*
+ * The sequence counter of a record is odd while the record is written. A reader waits for an even counter, copies
+ * the record and repeats the copy if the counter changed meanwhile, so it never returns a record mixed from two
+ * writes. The writer never waits. Only one writer per record is allowed, and a reader must not be an interrupt
+ * which preempts the writer on its own core, it would wait forever. The record and its counter are accessed
+ * through the non-cached LMU segment, the barriers order the counter against the fields.
+ *
+ *  Writer:                                             Reader:
+ *      uint32 sequence = seqlock_write_begin(&counter);    uint32 sequence;
+ *      ... write the fields ...                            do{
+ *      seqlock_write_end(&counter, sequence);                  sequence = seqlock_read_begin(&counter);
+ *                                                              ... copy the fields ...
+ *                                                          }while(seqlock_read_retry(&counter, sequence));
+ */
+
+/*********************************************************************************************************************/
+/*---------------------------------------------Function Definitions--------------------------------------------------*/
+/*********************************************************************************************************************/
+/**
+ * @brief Write start function.
+ * @details This function marks the record as being written before the first field changes.
+ * @param[in,out] counter : Sequence counter of the record.
+ * @return Counter value before the write, passed to #seqlock_write_end.
+ */
+IFX_INLINE uint32 seqlock_write_begin(volatile uint32 *counter){
+    uint32 sequence = *counter;
+
+    *counter = sequence + 1;
+    __dsync();
+    return sequence;
+}
+
+/**
+ * @brief Write end function.
+ * @details This function marks the record as consistent again after all fields are written.
+ * @param[in,out] counter : Sequence counter of the record.
+ * @param[in] sequence : Value returned by #seqlock_write_begin.
+ * @return Nothing.
+ */
+IFX_INLINE void seqlock_write_end(volatile uint32 *counter, uint32 sequence){
+    __dsync();
+    *counter = sequence + 2;
+}
+
+/**
+ * @brief Read start function.
+ * @details This function waits until no write of the record is running.
+ * @param[in] counter : Sequence counter of the record.
+ * @return Counter value before the copy, passed to #seqlock_read_retry.
+ */
+IFX_INLINE uint32 seqlock_read_begin(const volatile uint32 *counter){
+    uint32 sequence;
+
+    do{
+        sequence = *counter;
+    }while(sequence & 1);
+    __dsync();
+    return sequence;
+}
+
+/**
+ * @brief Read retry function.
+ * @details This function checks if a write started during the copy of the record.
+ * @param[in] counter : Sequence counter of the record.
+ * @param[in] sequence : Value returned by #seqlock_read_begin.
+ * @return TRUE if the copy overlapped a write and must be repeated.
+ */
+IFX_INLINE boolean seqlock_read_retry(const volatile uint32 *counter, uint32 sequence){
+    __dsync();
+    return *counter != sequence;
+}
+
+#endif /* SEQLOCK_H_ */
@@ -0,0 +1,101 @@
+/*
+ * shared_vitals.c
+ *
+ *  Created on: 17.10.2026
+ *      Author: Andreas Reichenauer
+ */
+
+/*!
+ * @file shared_vitals.c
+ * @brief This file implements the lock-free publication of the vitals from CPU1 to the other cores.
+ */
+
+#include <IfxCpu.h>
+#include <shared_vitals.h>
+#include <memory_placement.h>
+#include <seqlock.h>
+
+/*************************************************************************************************************/
+/*-------------------------------------------------Type Definitions------------------------------------------*/
+/*************************************************************************************************************/
+typedef struct
+{
+    volatile uint32 sequence;           // odd while the record is written
+    volatile sint32 heart_rate;
+    volatile uint8 spo2;
+    volatile uint8 confidence;
+
+} shared_vitals_slot_t;
+
+/*************************************************************************************************************/
+/*-------------------------------------------------Global variables------------------------------------------*/
+/*************************************************************************************************************/
+// record in the LMU, reachable by all cores without crossing the scratchpad of another core
+static shared_vitals_slot_t vitals_slot LMU_BSS;
+
+#if SHARED_VITALS_STRESS_TEST
+shared_vitals_stress_t shared_vitals_stress CPU2_BSS;
+#endif
+
+/*************************************************************************************************************/
+/*---------------------------------------------Function Implementations--------------------------------------*/
+/*************************************************************************************************************/
+static shared_vitals_slot_t *get_slot(void){
+    // all accesses go through the non-cached segment
+    return (shared_vitals_slot_t*)LMU_NON_CACHED(&vitals_slot);
+}
+
+void shared_vitals_publish(const shared_vitals_t *vitals){
+    shared_vitals_slot_t *slot = get_slot();
+    uint32 sequence = seqlock_write_begin(&slot->sequence);
+
+    slot->heart_rate = vitals->heart_rate;
+    slot->spo2 = vitals->spo2;
+    slot->confidence = vitals->confidence;
+
+    seqlock_write_end(&slot->sequence, sequence);
+}
+
+void shared_vitals_read(shared_vitals_t *vitals){
+    shared_vitals_slot_t *slot = get_slot();
+    uint32 sequence;
+
+    do{
+        sequence = seqlock_read_begin(&slot->sequence);
+
+        vitals->heart_rate = slot->heart_rate;
+        vitals->spo2 = slot->spo2;
+        vitals->confidence = slot->confidence;
+    }while(seqlock_read_retry(&slot->sequence, sequence));
+}
+
+#if SHARED_VITALS_STRESS_TEST
+void shared_vitals_stress_writer(void){
+    shared_vitals_t vitals;
+    sint32 number = 0;
+
+    while(1){
+        number++;
+        vitals.heart_rate = number;
+        vitals.spo2 = (uint8)number;
+        vitals.confidence = (uint8)(number >> 8);
+        shared_vitals_publish(&vitals);
+    }
+}
+
+void shared_vitals_stress_reader(void){
+    shared_vitals_t vitals;
+
+    while(1){
+        shared_vitals_read(&vitals);
+        shared_vitals_stress.reads++;
+
+        // the low bytes of the number are stored in the other fields of the same publish
+        if(vitals.spo2 != (uint8)vitals.heart_rate || vitals.confidence != (uint8)(vitals.heart_rate >> 8))
+            shared_vitals_stress.torn++;
+        if(vitals.heart_rate < shared_vitals_stress.last_heart_rate)
+            shared_vitals_stress.backwards++;
+        shared_vitals_stress.last_heart_rate = vitals.heart_rate;
+    }
+}
+#endif
@@ -0,0 +1,102 @@
+/*
+ * shared_vitals.h
+ *
+ *  Created on: 17.10.2026
+ *      Author: Andreas Reichenauer
+ */
+
+/*!
+ * @file shared_vitals.h
+ * @brief This file contains the lock-free publication of the vitals from CPU1 to the other cores.
+ */
+
+#ifndef SHARED_VITALS_H_
+#define SHARED_VITALS_H_
+
+#include <Ifx_Types.h>
+
+/*********************************************************************************************************************/
+/*------------------------------------------------------Macros-------------------------------------------------------*/
+/*********************************************************************************************************************/
+// set to 1 to replace the sensor on CPU1 by a writer which publishes as fast as it can and the UART loop on CPU2 by a
+// reader which checks that every read record comes from one publish
+#define SHARED_VITALS_STRESS_TEST           0
+
+/*********************************************************************************************************************/
+/*---------------------------------------------Type Definitions------------------------------------------------------*/
+/*********************************************************************************************************************/
+/**
+ * @brief Vitals record.
+ * @details Values published by one calculation.
+ */
+typedef struct
+{
+    sint32 heart_rate;      /**< Heart rate value. */
+    uint8 spo2;             /**< SpO2 value. */
+    uint8 confidence;       /**< Confidence of the values. */
+
+} shared_vitals_t;
+
+#if SHARED_VITALS_STRESS_TEST
+/**
+ * @brief Stress test results.
+ * @details Counters of the cross-core check, read them with the debugger.
+ */
+typedef struct
+{
+    uint32 reads;           /**< Number of checked reads. */
+    uint32 torn;            /**< Reads whose fields come from different publishes. */
+    uint32 backwards;       /**< Reads older than the read before. */
+    sint32 last_heart_rate; /**< Heart rate of the last read, the number of the publish. */
+
+} shared_vitals_stress_t;
+
+extern shared_vitals_stress_t shared_vitals_stress;
+#endif
+
+/*********************************************************************************************************************/
+/*---------------------------------------------Function Definitions----------------------------------------------*/
+/*********************************************************************************************************************/
+/**
+ * @brief Vitals publish function.
+ * @details This function stores a new vitals record in the LMU. The
+ * sequence counter is odd while the record is written, so readers detect
+ * and repeat reads which overlap the write. It never waits and never fails.
+ * @param[in] vitals : Record to publish.
+ * @return Nothing.
+ * @note Only one writer is allowed, the record is written by CPU1.
+ */
+void shared_vitals_publish(const shared_vitals_t *vitals);
+
+/**
+ * @brief Vitals read function.
+ * @details This function copies the last published vitals record. The copy
+ * is repeated until no write overlapped it, so it is always consistent.
+ * @param[out] vitals : Copy of the last published record.
+ * @return Nothing.
+ * @note The writer needs only a few cycles, so a repeat is rare. Must not be
+ * called by an interrupt which preempts the writer on its own core.
+ */
+void shared_vitals_read(shared_vitals_t *vitals);
+
+#if SHARED_VITALS_STRESS_TEST
+/**
+ * @brief Stress test writer function.
+ * @details This function publishes numbered records without pause, all
+ * fields of a record are derived from its number. It never returns.
+ * @return Nothing.
+ * @note Called by CPU1 instead of the sensor reading.
+ */
+void shared_vitals_stress_writer(void);
+
+/**
+ * @brief Stress test reader function.
+ * @details This function reads the records without pause and counts the
+ * reads whose fields do not belong to one publish. It never returns.
+ * @return Nothing.
+ * @note Called by another core than the writer, the results are in #shared_vitals_stress.
+ */
+void shared_vitals_stress_reader(void);
+#endif
+
+#endif /* SHARED_VITALS_H_ */
@@ -0,0 +1,97 @@
+/*
+ * stack_monitor.c
+ *
+ *  Created on: 17.10.2026
+ *      Author: Andreas Reichenauer
+ */
+
+#include <IfxCpu.h>
+#include <stack_monitor.h>
+
+/*************************************************************************************************************/
+/*------------------------------------------------------Macros-----------------------------------------------*/
+/*************************************************************************************************************/
+#define PAINT_MARGIN_WORDS      16                                  // Words below the caller kept for the painting itself
+
+/*************************************************************************************************************/
+/*-------------------------------------------------Type Definitions------------------------------------------*/
+/*************************************************************************************************************/
+typedef struct
+{
+    uint32 *bottom;                     // Lowest address, the stack grows down to it
+    uint32 *top;                        // Initial stack pointer, first address above the stack
+
+} stack_area_t;
+
+/*************************************************************************************************************/
+/*-------------------------------------------------Global variables------------------------------------------*/
+/*************************************************************************************************************/
+// stack bounds provided by Lcf_Gnuc_Tricore_Tc.lsl and Lcf_Tasking_Tricore_Tc.lsl
+extern uint32 __USTACK0[], __USTACK0_END[], __ISTACK0[], __ISTACK0_END[];
+extern uint32 __USTACK1[], __USTACK1_END[], __ISTACK1[], __ISTACK1_END[];
+extern uint32 __USTACK2[], __USTACK2_END[], __ISTACK2[], __ISTACK2_END[];
+
+static const stack_area_t stack_areas[STACK_MONITOR_CORE_COUNT][STACK_MONITOR_STACK_COUNT] = {
+    {{__USTACK0_END, __USTACK0}, {__ISTACK0_END, __ISTACK0}},
+    {{__USTACK1_END, __USTACK1}, {__ISTACK1_END, __ISTACK1}},
+    {{__USTACK2_END, __USTACK2}, {__ISTACK2_END, __ISTACK2}}
+};
+
+static boolean warned[STACK_MONITOR_CORE_COUNT][STACK_MONITOR_STACK_COUNT] = {{FALSE}};   // Warning was returned
+
+/*********************************************************************************************************************/
+/*---------------------------------------------Function Implementations----------------------------------------------*/
+/*********************************************************************************************************************/
+static void paint(uint32 *bottom, uint32 *top){
+    for(volatile uint32 *word = bottom; word < top; word++)
+        *word = STACK_MONITOR_PATTERN;
+}
+
+
+void stack_monitor_init(void){
+    const stack_area_t *areas = stack_areas[IfxCpu_getCoreIndex()];
+    uint32 marker;
+
+    // the frames of this function and its callers are in use, only the stack below them is painted
+    paint(areas[STACK_MONITOR_USER].bottom, &marker - PAINT_MARGIN_WORDS);
+
+    // no interrupt of this core is active while its main runs, the whole stack is free
+    paint(areas[STACK_MONITOR_INTERRUPT].bottom, areas[STACK_MONITOR_INTERRUPT].top);
+}
+
+
+void stack_monitor_get_usage(uint8 core, stack_monitor_stack_t stack, stack_usage_t *usage){
+    if(core >= STACK_MONITOR_CORE_COUNT || stack >= STACK_MONITOR_STACK_COUNT) return;
+
+    const stack_area_t *area = &stack_areas[core][stack];
+    volatile uint32 *word = area->bottom;
+
+    // the stack grows down, the first overwritten word from the bottom is the deepest use
+    while(word < area->top && *word == STACK_MONITOR_PATTERN)
+        word++;
+
+    usage->size = (uint32)area->top - (uint32)area->bottom;
+    usage->peak = (uint32)area->top - (uint32)word;
+}
+
+
+boolean stack_monitor_take_warning(uint8 *core, stack_monitor_stack_t *stack){
+    stack_usage_t usage;
+
+    for(uint8 n_core = 0; n_core < STACK_MONITOR_CORE_COUNT; n_core++){
+        for(uint8 n_stack = 0; n_stack < STACK_MONITOR_STACK_COUNT; n_stack++){
+            if(warned[n_core][n_stack])
+                continue;
+
+            stack_monitor_get_usage(n_core, (stack_monitor_stack_t)n_stack, &usage);
+            if(usage.peak * 100 >= usage.size * STACK_MONITOR_WARN_PERCENT){
+                warned[n_core][n_stack] = TRUE;
+                *core = n_core;
+                *stack = (stack_monitor_stack_t)n_stack;
+                return TRUE;
+            }
+        }
+    }
+
+    return FALSE;
+}
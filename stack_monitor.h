@@ -0,0 +1,75 @@
+/*
+ * stack_monitor.h
+ *
+ *  Created on: 17.10.2026
+ *      Author: Andreas Reichenauer
+ */
+
+#ifndef STACK_MONITOR_H_
+#define STACK_MONITOR_H_
+
+#include <Ifx_Types.h>
+
+/*********************************************************************************************************************/
+/*------------------------------------------------------Macros-------------------------------------------------------*/
+/*********************************************************************************************************************/
+#define STACK_MONITOR_CORE_COUNT    3           // Number of cores with their own stacks
+#define STACK_MONITOR_PATTERN       0xCDCDCDCD  // Value painted into the unused stack
+#define STACK_MONITOR_WARN_PERCENT  75          // Peak usage of a stack which is reported as a warning
+#define STACK_MONITOR_DUMP_COMMAND  's'         // Character received via UART which dumps the peak usage
+
+/*********************************************************************************************************************/
+/*---------------------------------------------Type Definitions----------------------------------------------*/
+/*********************************************************************************************************************/
+/***
+ * @brief: stacks of a core as defined by the linker script, the interrupt stack is used by interrupts which preempt
+ * the user code, nested interrupts stay on it
+ */
+typedef enum
+{
+    STACK_MONITOR_USER = 0,         // __USTACKn_END to __USTACKn
+    STACK_MONITOR_INTERRUPT,        // __ISTACKn_END to __ISTACKn
+    STACK_MONITOR_STACK_COUNT
+
+} stack_monitor_stack_t;
+
+/***
+ * @brief: usage of one stack in bytes
+ */
+typedef struct
+{
+    uint32 size;                    // Size of the stack
+    uint32 peak;                    // Deepest use since the stack was painted
+
+} stack_usage_t;
+
+/*********************************************************************************************************************/
+/*---------------------------------------------Function Definitions----------------------------------------------*/
+/*********************************************************************************************************************/
+/***
+ * @brief: paints the user stack below the calling function and the whole interrupt stack of the calling core.
+ * Called once by each core at the start of its main, before it starts interrupts which use the interrupt stack
+ * @params: none
+ * @returns: void
+ */
+void stack_monitor_init(void);
+
+/***
+ * @brief: returns the peak usage of a stack by searching the deepest word which is not the pattern anymore. Can be
+ * called by any core, the stacks are read over their global addresses
+ * @params: uint8, the index of the core
+ * @params: stack_monitor_stack_t, the stack
+ * @params: stack_usage_t pointer, the size and peak usage of the stack
+ * @returns: void
+ */
+void stack_monitor_get_usage(uint8 core, stack_monitor_stack_t stack, stack_usage_t *usage);
+
+/***
+ * @brief: searches the next stack whose peak usage crossed STACK_MONITOR_WARN_PERCENT, every stack is returned once
+ * @params: uint8 pointer, the index of the core
+ * @params: stack_monitor_stack_t pointer, the stack
+ * @returns: boolean, TRUE if a stack crossed the threshold since the last call
+ */
+boolean stack_monitor_take_warning(uint8 *core, stack_monitor_stack_t *stack);
+
+#endif /* STACK_MONITOR_H_ */
@@ -0,0 +1,89 @@
+/*
+ * task_loop.c
+ *
+ *  Created on: 17.10.2026
+ *      Author: Andreas Reichenauer
+ */
+
+#include <Bsp.h>
+#include <task_loop.h>
+#include <memory_placement.h>
+#include <cpu_load.h>
+
+/*************************************************************************************************************/
+/*-------------------------------------------------Global variables------------------------------------------*/
+/*************************************************************************************************************/
+static task_fptr_t task_functions[TASK_LOOP_MAX_TASKS] = {NULL};   // Functions of the tasks
+static volatile uint32 pending_tasks = 0;                           // One bit per task with a pending event
+static volatile uint8 running_task = TASK_LOOP_MAX_TASKS;           // Id of the running task, TASK_LOOP_MAX_TASKS if none
+static task_stats_t task_stats[TASK_LOOP_MAX_TASKS] CPU1_BSS;       // Run statistics of the tasks
+
+/*********************************************************************************************************************/
+/*---------------------------------------------Function Implementations----------------------------------------------*/
+/*********************************************************************************************************************/
+void init_task(uint8 task_id, task_fptr_t task_function_){
+    if(task_id >= TASK_LOOP_MAX_TASKS) return;
+
+    task_functions[task_id] = task_function_;                           // Set task function
+}
+
+
+void post_task_event(uint8 task_id){
+    if(task_id >= TASK_LOOP_MAX_TASKS) return;
+
+    boolean int_enabled = IfxCpu_disableInterrupts();                   // Pending bits are shared with the interrupts
+
+    if(pending_tasks & (1u << task_id))
+        task_stats[task_id].overruns++;                                 // Last event not handled yet, count instead of stacking
+    else{
+        if(running_task == task_id)
+            task_stats[task_id].overruns++;                             // Last event still running, the task runs late once more
+        pending_tasks |= (1u << task_id);
+    }
+
+    IfxCpu_restoreInterrupts(int_enabled);
+}
+
+
+void run_task_loop(void){
+    while(1){
+        uint32 pending = pending_tasks;
+        if(pending == 0){
+            cpu_load_idle();                                            // Nothing to do, count the time as idle
+            continue;
+        }
+        cpu_load_busy();
+
+        // lowest pending id has the highest priority
+        uint8 task_id = 0;
+        while(!(pending & (1u << task_id)))
+            task_id++;
+
+        boolean int_enabled = IfxCpu_disableInterrupts();               // Take the event, a new one may be posted while the task runs
+        pending_tasks &= ~(1u << task_id);
+        running_task = task_id;
+        IfxCpu_restoreInterrupts(int_enabled);
+
+        if(task_functions[task_id] == NULL){                            // If defined run the task function
+            running_task = TASK_LOOP_MAX_TASKS;
+            continue;
+        }
+
+        Ifx_TickTime start = now();
+        task_functions[task_id]();
+        uint32 ticks = (uint32)(now() - start);
+        running_task = TASK_LOOP_MAX_TASKS;
+
+        task_stats[task_id].runs++;
+        task_stats[task_id].last_ticks = ticks;
+        if(ticks > task_stats[task_id].max_ticks)
+            task_stats[task_id].max_ticks = ticks;
+    }
+}
+
+
+const task_stats_t *get_task_stats(uint8 task_id){
+    if(task_id >= TASK_LOOP_MAX_TASKS) return NULL;
+
+    return &task_stats[task_id];
+}
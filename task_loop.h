@@ -0,0 +1,68 @@
+/*
+ * task_loop.h
+ *
+ *  Created on: 17.10.2026
+ *      Author: Andreas Reichenauer
+ */
+
+#ifndef TASK_LOOP_H_
+#define TASK_LOOP_H_
+
+#include <Ifx_Types.h>
+
+/*********************************************************************************************************************/
+/*------------------------------------------------------Macros-------------------------------------------------------*/
+/*********************************************************************************************************************/
+#define TASK_LOOP_MAX_TASKS         8       // Max number of tasks, the task id is also the priority (0 = highest)
+
+/*********************************************************************************************************************/
+/*---------------------------------------------Type Definitions----------------------------------------------*/
+/*********************************************************************************************************************/
+typedef void (*task_fptr_t)(void);          // function type of a run-to-completion task
+
+/***
+ * @brief: statistics of one task, the times are measured in STM ticks
+ */
+typedef struct
+{
+    uint32 runs;                // Number of finished runs
+    uint32 overruns;            // Number of events posted while the last event was not handled yet
+    uint32 last_ticks;          // Run time of the last run
+    uint32 max_ticks;           // Longest run time
+
+} task_stats_t;
+
+/*********************************************************************************************************************/
+/*---------------------------------------------Function Definitions----------------------------------------------*/
+/*********************************************************************************************************************/
+/***
+ * @brief: sets the function of a task, the task id is its priority, a lower id runs first
+ * @params: uint8, the id of the task
+ * @params: task_fptr_t, the function run for each event of the task
+ * @returns: void
+ */
+void init_task(uint8 task_id, task_fptr_t task_function_);
+
+/***
+ * @brief: marks a task as ready to run, can be called from interrupts. If the task is still pending or running from
+ * the last event, the events are not stacked up but counted as an overrun
+ * @params: uint8, the id of the task
+ * @returns: void
+ */
+void post_task_event(uint8 task_id);
+
+/***
+ * @brief: runs the pending tasks one after the other by priority, each to completion, never returns
+ * @params: none
+ * @returns: void
+ */
+void run_task_loop(void);
+
+/***
+ * @brief: returns the run statistics of a task
+ * @params: uint8, the id of the task
+ * @returns: const task_stats_t*, statistics of the task
+ */
+const task_stats_t *get_task_stats(uint8 task_id);
+
+#endif /* TASK_LOOP_H_ */
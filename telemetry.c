@@ -0,0 +1,131 @@
+/*
+ * telemetry.c
+ *
+ *  Created on: 17.10.2026
+ *      Author: Andreas Reichenauer
+ */
+
+#include <Bsp.h>
+#include <IfxCpu.h>
+#include <stdio.h>
+#include <string.h>
+#include <telemetry.h>
+#include <UART.h>
+#include <memory_placement.h>
+#include <profiler.h>
+
+/*************************************************************************************************************/
+/*-------------------------------------------------Global variables------------------------------------------*/
+/*************************************************************************************************************/
+// the interrupts only write the records and the head, the main loop only the tail, so neither has to lock the other
+static telemetry_record_t queue[TELEMETRY_QUEUE_SIZE] CPU2_BSS;
+static volatile uint32 head CPU2_BSS;                       // Records posted since the start
+static volatile uint32 tail CPU2_BSS;                       // Records taken since the start
+static volatile uint32 dropped CPU2_BSS;                    // Records which did not fit into the queue
+static uint32 reported_dropped CPU2_BSS;                    // Dropped records in the last report
+
+static char line[TELEMETRY_LINE_SIZE] CPU2_BSS;             // Line waiting for space in the UART buffer
+static Ifx_SizeT line_length CPU2_BSS;                      // 0 if no line is waiting
+static uint32 ticks_per_second CPU2_BSS;
+
+/*********************************************************************************************************************/
+/*---------------------------------------------Function Implementations----------------------------------------------*/
+/*********************************************************************************************************************/
+void telemetry_init(void){
+    PLACEMENT_CHECK(queue, MEMORY_CPU2_DSPR);
+
+    head = 0;
+    tail = 0;
+    dropped = 0;
+    reported_dropped = 0;
+    line_length = 0;
+    ticks_per_second = (uint32)IfxStm_getTicksFromMilliseconds(BSP_DEFAULT_TIMER, 1000);
+}
+
+
+boolean telemetry_post(const telemetry_record_t *record){
+    uint32 index = head;
+
+    if(index - tail >= TELEMETRY_QUEUE_SIZE){
+        dropped++;
+        return FALSE;
+    }
+
+    queue[index % TELEMETRY_QUEUE_SIZE] = *record;
+    head = index + 1;                                       // The record is complete before the main loop sees it
+    return TRUE;
+}
+
+
+/*
+ * Formats a record into the line in the format of the former send functions,
+ * values as "[xxh:xxm:xxs] xBPM, x%SpO2,"
+ */
+static void format_record(const telemetry_record_t *record){
+    int length;
+
+    switch(record->type){
+    case TELEMETRY_VALUES:{
+        uint32 total_seconds = (uint32)(record->timestamp / (uint64)ticks_per_second);
+
+        PROFILE_BEGIN(PROFILE_TELEMETRY_FORMAT);
+        length = snprintf(line, sizeof(line), "[%02luh:%02lum:%02lus] %dBPM, %ld%%SpO2,\n",
+                          (unsigned long)(total_seconds / 3600), (unsigned long)((total_seconds / 60) % 60),
+                          (unsigned long)(total_seconds % 60), record->heart_rate, (long)record->value);
+        PROFILE_END(PROFILE_TELEMETRY_FORMAT);
+        break;
+    }
+    case TELEMETRY_INIT_TIME:
+        length = snprintf(line, sizeof(line), "Sensor ready after %luus\n", (unsigned long)record->value);
+        break;
+    case TELEMETRY_FIRST_READING:
+        length = snprintf(line, sizeof(line), "First reading after %luus\n", (unsigned long)record->value);
+        break;
+    default:
+        length = 0;
+        break;
+    }
+
+    // a cut line is still sent, it ends without its line feed
+    if(length < 0)
+        length = 0;
+    line_length = (length < (int)sizeof(line)) ? (Ifx_SizeT)length : (Ifx_SizeT)(sizeof(line) - 1);
+}
+
+
+boolean telemetry_drain(void){
+    while(1){
+        if(line_length == 0){
+            uint32 dropped_now = dropped;
+
+            if(dropped_now != reported_dropped){
+                line_length = (Ifx_SizeT)snprintf(line, sizeof(line), "Telemetry dropped %lu records\n",
+                                                  (unsigned long)(dropped_now - reported_dropped));
+                reported_dropped = dropped_now;
+            }
+            else if(tail != head){
+                format_record(&queue[tail % TELEMETRY_QUEUE_SIZE]);
+                __dsync();                                  // The record is read before its slot is given back
+                tail = tail + 1;
+            }
+            else{
+                return FALSE;
+            }
+        }
+
+        // the line is only written as a whole, it stays for the next call while the transmit buffer is full
+        if(line_length > 0 && !uart_trySendMessage((uint8*)line, line_length))
+            return TRUE;
+        line_length = 0;
+    }
+}
+
+
+boolean telemetry_pending(void){
+    return line_length != 0 || tail != head || dropped != reported_dropped;
+}
+
+
+uint32 telemetry_get_dropped(void){
+    return dropped;
+}
@@ -0,0 +1,83 @@
+/*
+ * telemetry.h
+ *
+ *  Created on: 17.10.2026
+ *      Author: Andreas Reichenauer
+ */
+
+#ifndef TELEMETRY_H_
+#define TELEMETRY_H_
+
+#include <Ifx_Types.h>
+
+/*********************************************************************************************************************/
+/*------------------------------------------------------Macros-------------------------------------------------------*/
+/*********************************************************************************************************************/
+#define TELEMETRY_QUEUE_SIZE        16          // Records waiting for the UART, a power of two
+#define TELEMETRY_LINE_SIZE         48          // Longest line, below the size of the UART transmit buffer
+
+/*********************************************************************************************************************/
+/*---------------------------------------------Type Definitions----------------------------------------------*/
+/*********************************************************************************************************************/
+typedef enum
+{
+    TELEMETRY_VALUES = 0,           // heart rate and SpO2 of a measurement with its timestamp
+    TELEMETRY_INIT_TIME,            // time the sensor needed for its initialization
+    TELEMETRY_FIRST_READING         // time from the initialization until the first valid values
+
+} telemetry_type_t;
+
+/***
+ * @brief: one record, formatted into a line of text when it is sent
+ */
+typedef struct
+{
+    uint64 timestamp;               // STM ticks of the measurement
+    sint32 value;                   // SpO2 or the time in us
+    uint8 heart_rate;               // Heart rate of the measurement, 0 if invalid or above 255
+    uint8 type;                     // telemetry_type_t
+
+} telemetry_record_t;
+
+/*********************************************************************************************************************/
+/*---------------------------------------------Function Definitions----------------------------------------------*/
+/*********************************************************************************************************************/
+/***
+ * @brief: empties the queue, called once by CPU2 before it starts the interrupts which post records
+ * @params: none
+ * @returns: void
+ */
+void telemetry_init(void);
+
+/***
+ * @brief: adds a record to the queue without waiting, called by the interrupts of CPU2. A record which does not fit
+ * into the queue is dropped and counted
+ * @params: telemetry_record_t pointer, the record which is copied
+ * @returns: boolean, FALSE if the record was dropped
+ */
+boolean telemetry_post(const telemetry_record_t *record);
+
+/***
+ * @brief: formats the queued records and writes them into the UART transmit buffer as long as there is space, a
+ * line which does not fit is kept for the next call. Reports the number of dropped records once they change.
+ * Called by the main loop of CPU2, it never waits
+ * @params: none
+ * @returns: boolean, TRUE if there is still something to send
+ */
+boolean telemetry_drain(void);
+
+/***
+ * @brief: returns if a record, a report of dropped records or a line is waiting to be sent
+ * @params: none
+ * @returns: boolean, TRUE if telemetry_drain has something to do
+ */
+boolean telemetry_pending(void);
+
+/***
+ * @brief: returns the number of records dropped since the start
+ * @params: none
+ * @returns: uint32, the number of dropped records
+ */
+uint32 telemetry_get_dropped(void);
+
+#endif /* TELEMETRY_H_ */
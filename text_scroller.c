@@ -0,0 +1,121 @@
+/*
+ * text_scroller.c
+ *
+ *  Created on: 17.10.2026
+ *      Author: Andreas Reichenauer
+ */
+
+#include <IfxCpu.h>
+#include <IfxCpu_Irq.h>
+#include <IfxStm.h>
+#include <string.h>
+#include <text_scroller.h>
+#include <__c8x8r_driver.h>
+#include <memory_placement.h>
+
+/*************************************************************************************************************/
+/*------------------------------------------------------Macros-----------------------------------------------*/
+/*************************************************************************************************************/
+#define ISR_PRIORITY_SCROLL_STEP    2               // Below the display frame and the QSPI interrupts
+#define SCROLL_STM                  (&MODULE_STM1)  // Comparator 0 is used by the heart animation
+#define SCROLL_COMPARATOR           IfxStm_Comparator_1
+#define WINDOW_SIZE                 (IMAGE_SIZE * C8X8R_CHAIN_LENGTH)
+
+/*************************************************************************************************************/
+/*-------------------------------------------------Global variables------------------------------------------*/
+/*************************************************************************************************************/
+static uint8 window[WINDOW_SIZE] CPU0_BSS;                  // Columns on the display, in image order over the chain
+static const char *next_char CPU0_BSS;                      // Character the next column is taken from
+static uint8 next_column CPU0_BSS;                          // Column of the character taken next
+static uint8 blank_columns CPU0_BSS;                        // Columns left to scroll the end of the text out
+static uint32 step_ticks CPU0_BSS;                          // STM1 ticks of one scroll step
+static uint32 step_deadline CPU0_BSS;                       // STM1 time of the next step
+static volatile boolean running CPU0_BSS;                   // A text is scrolling
+
+/*********************************************************************************************************************/
+/*---------------------------------------------Function Implementations----------------------------------------------*/
+/*********************************************************************************************************************/
+IFX_INTERRUPT(interruptScrollStep, 0, ISR_PRIORITY_SCROLL_STEP);     // Adding the Interrupt Service Routine
+
+
+void interruptScrollStep(void){
+    uint8 column;
+
+    IfxStm_clearCompareFlag(SCROLL_STM, SCROLL_COMPARATOR);            // Clear the compare event
+
+    if(!running)
+        return;
+
+    if(*next_char != '\0'){
+        column = c8x8r_getGlyphColumn(*next_char, next_column);
+        if(++next_column == C8X8R_GLYPH_WIDTH){
+            next_column = 0;
+            next_char++;
+        }
+    }
+    else if(blank_columns > 0){
+        column = 0x00;
+        blank_columns--;
+    }
+    else{
+        running = FALSE;
+        return;
+    }
+
+    memmove(window, &window[1], WINDOW_SIZE - 1);
+    window[WINDOW_SIZE - 1] = column;
+    c8x8r_queueChainImage(window);
+
+    // the steps follow the last deadline, the speed does not depend on the SPI transfers
+    step_deadline += step_ticks;
+    IfxStm_updateCompare(SCROLL_STM, SCROLL_COMPARATOR, step_deadline);
+
+    // a deadline which passed while it was set would only match after the timer wrapped around
+    if((sint32)(step_deadline - IfxStm_getLower(SCROLL_STM)) <= 0){
+        step_deadline = IfxStm_getLower(SCROLL_STM) + step_ticks;
+        IfxStm_updateCompare(SCROLL_STM, SCROLL_COMPARATOR, step_deadline);
+    }
+}
+
+
+void text_scroller_init(void){
+    IfxStm_CompareConfig stmConfig;
+    IfxStm_initCompareConfig(&stmConfig);
+
+    stmConfig.comparator            = SCROLL_COMPARATOR;
+    stmConfig.comparatorInterrupt   = IfxStm_ComparatorInterrupt_ir1;
+    stmConfig.triggerPriority       = ISR_PRIORITY_SCROLL_STEP;
+    stmConfig.typeOfService         = IfxCpu_Irq_getTos(IfxCpu_getCoreIndex());
+    stmConfig.ticks                 = 0xFFFFFFFF;                       // No step until a text is started
+
+    running = FALSE;
+    IfxStm_initCompare(SCROLL_STM, &stmConfig);
+}
+
+
+void text_scroller_start(const char *text){
+    boolean int_enabled = IfxCpu_disableInterrupts();
+
+    memset(window, 0x00, sizeof(window));
+    next_char = text;
+    next_column = 0;
+    blank_columns = WINDOW_SIZE;
+    running = TRUE;
+
+    // every column is shown for one scroll time, the first one comes in after it
+    step_ticks = (uint32)IfxStm_getTicksFromMilliseconds(SCROLL_STM, c8x8r_getScrollTime());
+    step_deadline = IfxStm_getLower(SCROLL_STM) + step_ticks;
+    IfxStm_updateCompare(SCROLL_STM, SCROLL_COMPARATOR, step_deadline);
+    IfxStm_clearCompareFlag(SCROLL_STM, SCROLL_COMPARATOR);
+    IfxCpu_restoreInterrupts(int_enabled);
+}
+
+
+void text_scroller_stop(void){
+    running = FALSE;
+}
+
+
+boolean text_scroller_is_running(void){
+    return running;
+}
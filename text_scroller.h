@@ -0,0 +1,53 @@
+/*
+ * text_scroller.h
+ *
+ *  Created on: 17.10.2026
+ *      Author: Andreas Reichenauer
+ */
+
+#ifndef TEXT_SCROLLER_H_
+#define TEXT_SCROLLER_H_
+
+#include <Ifx_Types.h>
+
+/*********************************************************************************************************************/
+/*---------------------------------------------Function Definitions----------------------------------------------*/
+/*********************************************************************************************************************/
+/***
+ * @brief: interrupt handler called every scroll step, moves the text one column to the left
+ * @params: None
+ * @return: void
+ */
+void interruptScrollStep(void);
+
+/***
+ * @brief: sets up the scroll timer of the calling core, the display has to be initialised with c8x8r_init first
+ * @params: None
+ * @returns: void
+ */
+void text_scroller_init(void);
+
+/***
+ * @brief: scrolls a text over the display chain from the right to the left until its last column left the display.
+ * The columns are taken from the characters one step at a time, so the text can have any length, but it must stay
+ * valid until the scrolling is done. A running text is replaced. The speed is set with c8x8r_setSpeedScroll
+ * @params: const char pointer, the zero terminated text
+ * @returns: void
+ */
+void text_scroller_start(const char *text);
+
+/***
+ * @brief: stops the running text, the display keeps the last step
+ * @params: None
+ * @returns: void
+ */
+void text_scroller_stop(void);
+
+/***
+ * @brief: returns if a text is scrolling, the heart animation pauses while it does
+ * @params: None
+ * @returns: boolean, TRUE while a text is scrolling
+ */
+boolean text_scroller_is_running(void);
+
+#endif /* TEXT_SCROLLER_H_ */